@@ -0,0 +1,81 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef GRIDGAME_COUNT_ALLOCATIONS
+
+// Plain thread_local counters: no constructor, so they are safe to touch from
+// inside operator new on any thread.
+static thread_local long long allocationCount = 0;
+static thread_local long long allocationBytes = 0;
+
+bool allocationCountingEnabled() {
+    return true;
+}
+
+AllocationStats threadAllocationStats() {
+    return {allocationCount, allocationBytes};
+}
+
+// As the standard operator new does: on failure, call the new-handler and try
+// again until one is installed that gives up
+template <typename Allocate>
+static void* allocateOrHandle(Allocate allocate) {
+    for (;;) {
+        if (void* p = allocate()) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+static void* countedAlloc(std::size_t size) {
+    ++allocationCount;
+    allocationBytes += static_cast<long long>(size);
+    return allocateOrHandle([size]() { return std::malloc(size ? size : 1); });
+}
+
+static void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    ++allocationCount;
+    allocationBytes += static_cast<long long>(size);
+    std::size_t alignment = static_cast<std::size_t>(align);
+    std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+    return allocateOrHandle([=]() { return std::aligned_alloc(alignment, rounded ? rounded : alignment); });
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+#else
+
+// Built without the replacements: the system allocator, and nothing to count
+bool allocationCountingEnabled() {
+    return false;
+}
+
+AllocationStats threadAllocationStats() {
+    return {};
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// Heap allocations made by the calling thread since it started.
+// Counted by the global operator new replacements in AllocationCounter.cpp,
+// which are only built with GRIDGAME_COUNT_ALLOCATIONS (a CMake option, off by
+// default so the game keeps the system allocator). Without them the stats
+// stay zero.
+struct AllocationStats {
+    long long count = 0;
+    long long bytes = 0;
+};
+
+AllocationStats threadAllocationStats();
+bool allocationCountingEnabled();
@@ -0,0 +1,104 @@
+#include "BorderRenderer.hpp"
+#include "Profiler.hpp"
+#include "ProfilerOverlay.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+BorderRenderer::BorderRenderer(float cellSize) : cellSize(cellSize) {}
+
+void BorderRenderer::reset() {
+    chunkRows = chunkCols = 0;
+    chunks.clear();
+    builtVersions.clear();
+}
+
+sf::Color BorderRenderer::ownerColor(int owner) {
+    if (owner == 0) return sf::Color(200, 60, 220); // The player's tribe
+    // Spread AI tribes around the colour wheel with the golden angle
+    float hue = std::fmod(owner * 137.5f, 360.f) / 60.f;
+    float x = 1.f - std::abs(std::fmod(hue, 2.f) - 1.f);
+    float r = 0.f, g = 0.f, b = 0.f;
+    switch (static_cast<int>(hue)) {
+        case 0: r = 1.f; g = x; break;
+        case 1: r = x; g = 1.f; break;
+        case 2: g = 1.f; b = x; break;
+        case 3: g = x; b = 1.f; break;
+        case 4: r = x; b = 1.f; break;
+        default: r = 1.f; b = x; break;
+    }
+    return sf::Color(static_cast<std::uint8_t>(55 + 200 * r), static_cast<std::uint8_t>(55 + 200 * g),
+                     static_cast<std::uint8_t>(55 + 200 * b));
+}
+
+void BorderRenderer::update(const TerritoryMap& territory) {
+    PROFILE_SCOPE("BorderRenderer::update");
+    if (territory.getChunkRows() != chunkRows || territory.getChunkCols() != chunkCols) {
+        chunkRows = territory.getChunkRows();
+        chunkCols = territory.getChunkCols();
+        chunks.assign(chunkRows * chunkCols, sf::VertexArray(sf::PrimitiveType::Triangles));
+        builtVersions.assign(chunkRows * chunkCols, 0);
+    }
+
+    for (int chunkRow = 0; chunkRow < chunkRows; ++chunkRow) {
+        for (int chunkCol = 0; chunkCol < chunkCols; ++chunkCol) {
+            std::uint32_t version = territory.getChunkVersion(chunkRow, chunkCol);
+            if (version == builtVersions[chunkRow * chunkCols + chunkCol]) continue;
+            rebuildChunk(territory, chunkRow, chunkCol);
+            builtVersions[chunkRow * chunkCols + chunkCol] = version;
+        }
+    }
+}
+
+void BorderRenderer::rebuildChunk(const TerritoryMap& territory, int chunkRow, int chunkCol) {
+    sf::VertexArray& vertices = chunks[chunkRow * chunkCols + chunkCol];
+    vertices.clear();
+
+    const float width = cellSize * 0.18f;
+    auto strip = [&](sf::Vector2f topLeft, sf::Vector2f size, sf::Color color) {
+        sf::Vector2f topRight = topLeft + sf::Vector2f(size.x, 0.f);
+        sf::Vector2f bottomLeft = topLeft + sf::Vector2f(0.f, size.y);
+        sf::Vector2f bottomRight = topLeft + size;
+        vertices.append({topLeft, color});
+        vertices.append({topRight, color});
+        vertices.append({bottomLeft, color});
+        vertices.append({bottomLeft, color});
+        vertices.append({topRight, color});
+        vertices.append({bottomRight, color});
+    };
+
+    const int rowEnd = std::min(territory.getRows(), (chunkRow + 1) * TerritoryMap::ChunkSize);
+    const int colEnd = std::min(territory.getCols(), (chunkCol + 1) * TerritoryMap::ChunkSize);
+    for (int row = chunkRow * TerritoryMap::ChunkSize; row < rowEnd; ++row) {
+        for (int col = chunkCol * TerritoryMap::ChunkSize; col < colEnd; ++col) {
+            std::uint8_t edges = territory.getBorders(row, col);
+            if (edges == 0) continue;
+
+            sf::Color color = ownerColor(territory.getOwner(row, col));
+            sf::Vector2f corner(col * cellSize, row * cellSize);
+            if (edges & TerritoryMap::North) strip(corner, {cellSize, width}, color);
+            if (edges & TerritoryMap::South) strip(corner + sf::Vector2f(0.f, cellSize - width), {cellSize, width}, color);
+            if (edges & TerritoryMap::West) strip(corner, {width, cellSize}, color);
+            if (edges & TerritoryMap::East) strip(corner + sf::Vector2f(cellSize - width, 0.f), {width, cellSize}, color);
+        }
+    }
+}
+
+void BorderRenderer::draw(sf::RenderTarget& target, const sf::View& view) const {
+    PROFILE_SCOPE("BorderRenderer::draw");
+    const float chunkWorld = TerritoryMap::ChunkSize * cellSize;
+    const sf::Vector2f topLeft = view.getCenter() - view.getSize() / 2.f;
+    const sf::Vector2f bottomRight = view.getCenter() + view.getSize() / 2.f;
+
+    const int rowBegin = std::max(0, static_cast<int>(topLeft.y / chunkWorld));
+    const int rowEnd = std::min(chunkRows - 1, static_cast<int>(bottomRight.y / chunkWorld));
+    const int colBegin = std::max(0, static_cast<int>(topLeft.x / chunkWorld));
+    const int colEnd = std::min(chunkCols - 1, static_cast<int>(bottomRight.x / chunkWorld));
+
+    for (int chunkRow = rowBegin; chunkRow <= rowEnd; ++chunkRow) {
+        for (int chunkCol = colBegin; chunkCol <= colEnd; ++chunkCol) {
+            const sf::VertexArray& vertices = chunks[chunkRow * chunkCols + chunkCol];
+            if (vertices.getVertexCount() > 0) drawCounted(target, vertices);
+        }
+    }
+}
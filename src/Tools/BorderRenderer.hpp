@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../mechanics/Territory.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+// Draws territory borders as thin strips along the inside of each owned tile's
+// border edges, in the owner's colour. Geometry is kept per TerritoryMap chunk
+// and only rebuilt for chunks whose version moved since they were last built.
+class BorderRenderer {
+public:
+    explicit BorderRenderer(float cellSize);
+
+    // Cheap when nothing changed: one version compare per chunk
+    void update(const TerritoryMap& territory);
+    // Draws the chunks that overlap the view
+    void draw(sf::RenderTarget& target, const sf::View& view) const;
+    // Forget all geometry, e.g. when a new world replaces the territory
+    void reset();
+
+    static sf::Color ownerColor(int owner);
+
+private:
+    void rebuildChunk(const TerritoryMap& territory, int chunkRow, int chunkCol);
+
+    float cellSize;
+    int chunkRows = 0, chunkCols = 0;
+    std::vector<sf::VertexArray> chunks;
+    std::vector<std::uint32_t> builtVersions;
+};
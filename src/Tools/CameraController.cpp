@@ -0,0 +1,46 @@
+#include "CameraController.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+CameraController::CameraController(sf::FloatRect worldBounds, sf::Vector2f baseViewSize)
+    : worldBounds(worldBounds),
+      baseViewSize(baseViewSize),
+      center(worldBounds.position + worldBounds.size / 2.f),
+      targetCenter(center) {}
+
+void CameraController::setTarget(sf::Vector2f newCenter, float newZoom) {
+    targetCenter = newCenter;
+    targetZoom = newZoom;
+    clampTarget();
+}
+
+void CameraController::clampTarget() {
+    targetCenter.x = std::clamp(targetCenter.x, worldBounds.position.x, worldBounds.position.x + worldBounds.size.x);
+    targetCenter.y = std::clamp(targetCenter.y, worldBounds.position.y, worldBounds.position.y + worldBounds.size.y);
+    targetZoom = std::clamp(targetZoom, minZoom, maxZoom);
+}
+
+void CameraController::update(float deltaTime, sf::Vector2f pan, float zoomDirection) {
+    targetCenter += pan * (panSpeed * deltaTime);
+    targetZoom *= std::exp(zoomDirection * zoomRate * deltaTime);
+    clampTarget();
+
+    const float blend = 1.f - std::exp(-sharpness * deltaTime);
+    center += (targetCenter - center) * blend;
+    // Ease zoom in log space so zooming in and out feel the same
+    zoom = std::exp(std::log(zoom) + (std::log(targetZoom) - std::log(zoom)) * blend);
+}
+
+void CameraController::apply(sf::View& view) const {
+    view.setCenter(center);
+    view.setSize(baseViewSize * zoom);
+}
+
+sf::Vector2f CameraController::getCenter() const {
+    return center;
+}
+
+float CameraController::getZoom() const {
+    return zoom;
+}
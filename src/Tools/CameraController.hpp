@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+// Eases the view towards a target centre and zoom. Smoothing is exponential in
+// time (1 - e^(-sharpness * dt)), so the camera moves the same at any frame rate.
+// The target centre stays inside the world and the zoom inside [minZoom, maxZoom].
+class CameraController {
+public:
+    // Zoom 1 shows baseViewSize world units (the window's default view)
+    CameraController(sf::FloatRect worldBounds, sf::Vector2f baseViewSize);
+
+    void setTarget(sf::Vector2f center, float zoom);
+    // pan: -1..1 per axis, zoomDirection: -1 (in) .. 1 (out)
+    void update(float deltaTime, sf::Vector2f pan, float zoomDirection);
+    void apply(sf::View& view) const;
+
+    sf::Vector2f getCenter() const;
+    float getZoom() const;
+
+    float panSpeed = 500.f;    // world units per second
+    float zoomRate = 2.f;      // zoom doubles/halves about every 0.35 s
+    float sharpness = 40.f;    // about what 0.5 per frame was at 60 FPS
+    float minZoom = 0.03f;
+    float maxZoom = 1.5f;
+
+private:
+    void clampTarget();
+
+    sf::FloatRect worldBounds;
+    sf::Vector2f baseViewSize;
+    sf::Vector2f center;
+    sf::Vector2f targetCenter;
+    float zoom = 1.f;
+    float targetZoom = 1.f;
+};
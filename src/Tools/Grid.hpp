@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// A rows x cols grid in one flat buffer whose order is set by a layout:
+//
+//   RowMajorLayout   rows one after another, like the nested vectors
+//   TiledLayout<S>   (1 << S)-square blocks, each stored whole, blocks row-major
+//   MortonLayout     Z-order: row and column bits interleaved
+//
+// Every layout is used through the same calls (at, forEach, forEachNear), so a
+// pass is written once and mapgen_bench can time it on each layout. In a 3x3
+// or wider neighbourhood the row-major grid touches one cache line per row;
+// the blocked layouts keep most of the neighbourhood in the same few lines.
+// The cost is a dearer index and, for a grid not a multiple of the block,
+// some padding. Check mapgen_bench's layout/ cases before moving a pass over:
+// for the 3x3 and 5x5 passes there, row-major has so far come out ahead.
+//
+// A layout splits a tile's offset into a row part and a column part whose sum
+// is the offset (stencils work out the row part once per row), and walks the
+// grid in storage order, calling visit(row, col, offset) once per tile.
+
+struct RowMajorLayout {
+    static std::string name() { return "rowMajor"; }
+
+    RowMajorLayout() = default;
+    RowMajorLayout(int rows, int cols) : rows(rows), cols(cols) {}
+
+    std::size_t size() const { return static_cast<std::size_t>(rows) * cols; }
+    std::size_t rowOffset(int row) const { return static_cast<std::size_t>(row) * cols; }
+    std::size_t colOffset(int col) const { return static_cast<std::size_t>(col); }
+
+    template <typename Visit>
+    void forEachCell(Visit&& visit) const {
+        std::size_t offset = 0;
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) visit(r, c, offset++);
+        }
+    }
+
+    int rows = 0, cols = 0;
+};
+
+template <int Shift = 4>
+struct TiledLayout {
+    static constexpr int Side = 1 << Shift;
+    static constexpr int Mask = Side - 1;
+    static std::string name() { return "tiled" + std::to_string(Side); }
+
+    TiledLayout() = default;
+    TiledLayout(int rows, int cols)
+        : rows(rows), cols(cols), blockRows((rows + Mask) >> Shift), blockCols((cols + Mask) >> Shift) {}
+
+    std::size_t size() const { return static_cast<std::size_t>(blockRows) * blockCols << (2 * Shift); }
+    std::size_t rowOffset(int row) const {
+        return (static_cast<std::size_t>(row >> Shift) * blockCols << (2 * Shift)) + ((row & Mask) << Shift);
+    }
+    std::size_t colOffset(int col) const {
+        return (static_cast<std::size_t>(col >> Shift) << (2 * Shift)) + (col & Mask);
+    }
+
+    template <typename Visit>
+    void forEachCell(Visit&& visit) const {
+        for (int br = 0; br < blockRows; ++br) {
+            const int top = br << Shift, bottom = std::min(rows, top + Side);
+            for (int bc = 0; bc < blockCols; ++bc) {
+                const int left = bc << Shift, right = std::min(cols, left + Side);
+                const std::size_t base = (static_cast<std::size_t>(br) * blockCols + bc) << (2 * Shift);
+                for (int r = top; r < bottom; ++r) {
+                    const std::size_t line = base + (static_cast<std::size_t>(r - top) << Shift);
+                    for (int c = left; c < right; ++c) visit(r, c, line + (c - left));
+                }
+            }
+        }
+    }
+
+    int rows = 0, cols = 0;
+    int blockRows = 0, blockCols = 0;
+};
+
+// The shorter side is rounded up to a power of two and interleaved with the same
+// number of low bits of the longer side; the longer side's remaining bits go on
+// top, so a long thin map becomes a row of Z-ordered squares rather than one
+// mostly empty square. Row and column offsets are looked up in per-row and
+// per-column tables.
+struct MortonLayout {
+    static std::string name() { return "morton"; }
+
+    MortonLayout() = default;
+    MortonLayout(int rows, int cols)
+        : rows(rows), cols(cols), rowOffsets(rows), colOffsets(cols) {
+        rowBits = std::bit_width(static_cast<unsigned>(std::max(rows - 1, 0)));
+        colBits = std::bit_width(static_cast<unsigned>(std::max(cols - 1, 0)));
+        squareBits = std::min(rowBits, colBits);
+        const std::size_t low = (std::size_t(1) << squareBits) - 1;
+        for (int r = 0; r < rows; ++r) {
+            rowOffsets[r] = spread(r & low) << 1 | (rowBits > colBits ? std::size_t(r >> squareBits) << (2 * squareBits) : 0);
+        }
+        for (int c = 0; c < cols; ++c) {
+            colOffsets[c] = spread(c & low) | (colBits > rowBits ? std::size_t(c >> squareBits) << (2 * squareBits) : 0);
+        }
+    }
+
+    std::size_t size() const { return std::size_t(1) << (rowBits + colBits); }
+    std::size_t rowOffset(int row) const { return rowOffsets[row]; }
+    std::size_t colOffset(int col) const { return colOffsets[col]; }
+
+    // Walks the curve and skips the padding past the last row or column
+    template <typename Visit>
+    void forEachCell(Visit&& visit) const {
+        const std::size_t squareMask = (std::size_t(1) << (2 * squareBits)) - 1;
+        const std::size_t total = size();
+        for (std::size_t offset = 0; offset < total; ++offset) {
+            const std::size_t high = offset >> (2 * squareBits);
+            int r = static_cast<int>(compact((offset & squareMask) >> 1));
+            int c = static_cast<int>(compact(offset & squareMask));
+            if (rowBits > colBits) r |= static_cast<int>(high << squareBits);
+            else c |= static_cast<int>(high << squareBits);
+            if (r < rows && c < cols) visit(r, c, offset);
+        }
+    }
+
+    int rows = 0, cols = 0;
+    int rowBits = 0, colBits = 0, squareBits = 0;
+    std::vector<std::size_t> rowOffsets, colOffsets;
+
+private:
+    // Bit i of value moves to bit 2i, and back
+    static std::size_t spread(std::size_t value) {
+        std::uint64_t x = value & 0xffffffffu;
+        x = (x | x << 16) & 0x0000ffff0000ffffull;
+        x = (x | x << 8) & 0x00ff00ff00ff00ffull;
+        x = (x | x << 4) & 0x0f0f0f0f0f0f0f0full;
+        x = (x | x << 2) & 0x3333333333333333ull;
+        x = (x | x << 1) & 0x5555555555555555ull;
+        return static_cast<std::size_t>(x);
+    }
+    static std::size_t compact(std::size_t value) {
+        std::uint64_t x = value & 0x5555555555555555ull;
+        x = (x | x >> 1) & 0x3333333333333333ull;
+        x = (x | x >> 2) & 0x0f0f0f0f0f0f0f0full;
+        x = (x | x >> 4) & 0x00ff00ff00ff00ffull;
+        x = (x | x >> 8) & 0x0000ffff0000ffffull;
+        x = (x | x >> 16) & 0x00000000ffffffffull;
+        return static_cast<std::size_t>(x);
+    }
+};
+
+// The cells come from a memory resource, like a std::pmr container's, so a
+// generation stage can keep its working grids in its scratch arena.
+template <typename T, typename Layout = RowMajorLayout>
+class Grid {
+public:
+    using value_type = T;
+    using layout_type = Layout;
+
+    Grid() = default;
+    Grid(int rows, int cols, const T& value = T(),
+         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : rows(rows), cols(cols), layout(rows, cols), cells(layout.size(), value, resource) {}
+
+    // Copies nested vectors in (every row at least `cols` long)
+    static Grid fromRows(const std::vector<std::vector<T>>& source,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        const int rows = static_cast<int>(source.size());
+        Grid grid(rows, rows > 0 ? static_cast<int>(source[0].size()) : 0, T(), resource);
+        grid.forEach([&](int r, int c, T& value) { value = source[r][c]; });
+        return grid;
+    }
+    // Copies out to nested vectors, resizing them to match
+    void toRows(std::vector<std::vector<T>>& target) const {
+        target.resize(rows);
+        for (auto& row : target) row.resize(cols);
+        forEach([&](int r, int c, const T& value) { target[r][c] = value; });
+    }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    const Layout& getLayout() const { return layout; }
+    bool inBounds(int row, int col) const { return row >= 0 && row < rows && col >= 0 && col < cols; }
+
+    T& at(int row, int col) { return cells[layout.rowOffset(row) + layout.colOffset(col)]; }
+    const T& at(int row, int col) const { return cells[layout.rowOffset(row) + layout.colOffset(col)]; }
+
+    // Padding included, which nothing reads
+    void fill(const T& value) { std::fill(cells.begin(), cells.end(), value); }
+
+    // Calls fn(row, col, value) for every tile, in storage order. Passes that
+    // write each tile independently should walk the grid this way.
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        layout.forEachCell([&](int r, int c, std::size_t offset) { fn(r, c, cells[offset]); });
+    }
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        layout.forEachCell([&](int r, int c, std::size_t offset) { fn(r, c, cells[offset]); });
+    }
+
+    // Calls fn(row, col, value) for every tile up to `radius` rows and columns
+    // from (row, col), itself included, clipped to the grid. Row by row, top to
+    // bottom, so a pass gets the same result whatever the layout.
+    template <typename Fn>
+    void forEachNear(int row, int col, int radius, Fn&& fn) {
+        const int top = std::max(0, row - radius), bottom = std::min(rows - 1, row + radius);
+        const int left = std::max(0, col - radius), right = std::min(cols - 1, col + radius);
+        for (int r = top; r <= bottom; ++r) {
+            const std::size_t line = layout.rowOffset(r);
+            for (int c = left; c <= right; ++c) fn(r, c, cells[line + layout.colOffset(c)]);
+        }
+    }
+    template <typename Fn>
+    void forEachNear(int row, int col, int radius, Fn&& fn) const {
+        const int top = std::max(0, row - radius), bottom = std::min(rows - 1, row + radius);
+        const int left = std::max(0, col - radius), right = std::min(cols - 1, col + radius);
+        for (int r = top; r <= bottom; ++r) {
+            const std::size_t line = layout.rowOffset(r);
+            for (int c = left; c <= right; ++c) fn(r, c, cells[line + layout.colOffset(c)]);
+        }
+    }
+
+private:
+    int rows = 0, cols = 0;
+    Layout layout;
+    std::pmr::vector<T> cells;
+};
@@ -0,0 +1,77 @@
+#include "HitIndex.hpp"
+
+#include <algorithm>
+
+static const int LeafSize = 4;
+
+static sf::FloatRect merge(const sf::FloatRect& a, const sf::FloatRect& b) {
+    sf::Vector2f low(std::min(a.position.x, b.position.x), std::min(a.position.y, b.position.y));
+    sf::Vector2f high(std::max(a.position.x + a.size.x, b.position.x + b.size.x),
+                      std::max(a.position.y + a.size.y, b.position.y + b.size.y));
+    return {low, high - low};
+}
+
+void HitIndex::build(std::vector<Item> newItems) {
+    items = std::move(newItems);
+    nodes.clear();
+    if (!items.empty()) {
+        nodes.reserve(2 * items.size() / LeafSize + 1);
+        buildNode(0, static_cast<int>(items.size()));
+    }
+}
+
+int HitIndex::buildNode(int first, int count) {
+    int index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    sf::FloatRect bounds = items[first].rect;
+    for (int i = first + 1; i < first + count; ++i) bounds = merge(bounds, items[i].rect);
+    nodes[index].bounds = bounds;
+
+    if (count <= LeafSize) {
+        nodes[index].first = first;
+        nodes[index].count = count;
+        return index;
+    }
+
+    // Split at the median centre along the longer axis
+    bool splitX = bounds.size.x >= bounds.size.y;
+    auto centre = [splitX](const Item& item) {
+        return splitX ? item.rect.position.x + item.rect.size.x / 2.f : item.rect.position.y + item.rect.size.y / 2.f;
+    };
+    int half = count / 2;
+    std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+                     [&](const Item& a, const Item& b) { return centre(a) < centre(b); });
+
+    int left = buildNode(first, half);
+    int right = buildNode(first + half, count - half);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+int HitIndex::query(sf::Vector2f point) const {
+    if (nodes.empty()) return -1;
+
+    int best = -1;
+    int stack[64];
+    int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const Node& node = nodes[stack[--depth]];
+        if (!node.bounds.contains(point)) continue;
+        if (node.left == -1) {
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                if (items[i].id > best && items[i].rect.contains(point)) best = items[i].id;
+            }
+        } else {
+            stack[depth++] = node.left;
+            stack[depth++] = node.right;
+        }
+    }
+    return best;
+}
+
+bool HitIndex::empty() const {
+    return items.empty();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Bounding volume hierarchy over interactive rectangles. Rebuilt when the set of
+// rectangles changes; a point query visits O(log n) nodes for a typical UI where
+// rectangles rarely overlap.
+class HitIndex {
+public:
+    struct Item {
+        int id;              // higher ids are drawn on top and win overlaps
+        sf::FloatRect rect;
+    };
+
+    void build(std::vector<Item> items);
+    // Topmost item containing the point, or -1
+    int query(sf::Vector2f point) const;
+    bool empty() const;
+
+private:
+    struct Node {
+        sf::FloatRect bounds;
+        int left = -1;       // children, or -1 for a leaf
+        int right = -1;
+        int first = 0;       // leaf items
+        int count = 0;
+    };
+
+    int buildNode(int first, int count);
+
+    std::vector<Item> items;
+    std::vector<Node> nodes;
+};
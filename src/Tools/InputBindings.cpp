@@ -0,0 +1,121 @@
+#include "InputBindings.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+using Scancode = sf::Keyboard::Scancode;
+
+static const std::unordered_map<std::string, Scancode>& scancodeNames() {
+    static const std::unordered_map<std::string, Scancode> names = [] {
+        std::unordered_map<std::string, Scancode> table;
+        for (int i = 0; i < 26; ++i) {
+            table[std::string(1, static_cast<char>('A' + i))] =
+                static_cast<Scancode>(static_cast<int>(Scancode::A) + i);
+        }
+        for (int i = 0; i < 12; ++i) {
+            table["F" + std::to_string(i + 1)] = static_cast<Scancode>(static_cast<int>(Scancode::F1) + i);
+        }
+        table["Num1"] = Scancode::Num1; table["Num2"] = Scancode::Num2; table["Num3"] = Scancode::Num3;
+        table["Num4"] = Scancode::Num4; table["Num5"] = Scancode::Num5; table["Num6"] = Scancode::Num6;
+        table["Num7"] = Scancode::Num7; table["Num8"] = Scancode::Num8; table["Num9"] = Scancode::Num9;
+        table["Num0"] = Scancode::Num0;
+        table["Escape"] = Scancode::Escape;
+        table["Enter"] = Scancode::Enter;
+        table["Space"] = Scancode::Space;
+        table["Tab"] = Scancode::Tab;
+        table["Backspace"] = Scancode::Backspace;
+        table["Hyphen"] = Scancode::Hyphen;
+        table["Equal"] = Scancode::Equal;
+        table["Left"] = Scancode::Left;
+        table["Right"] = Scancode::Right;
+        table["Up"] = Scancode::Up;
+        table["Down"] = Scancode::Down;
+        table["LShift"] = Scancode::LShift;
+        table["RShift"] = Scancode::RShift;
+        table["LControl"] = Scancode::LControl;
+        table["RControl"] = Scancode::RControl;
+        return table;
+    }();
+    return names;
+}
+
+InputBindings::InputBindings() {
+    bind(Action::PanLeft, {Scancode::A});
+    bind(Action::PanRight, {Scancode::D});
+    bind(Action::PanUp, {Scancode::W});
+    bind(Action::PanDown, {Scancode::S});
+    bind(Action::ZoomIn, {Scancode::N});
+    bind(Action::ZoomOut, {Scancode::M});
+    bind(Action::Regenerate, {Scancode::R});
+    bind(Action::ToggleProfiler, {Scancode::F3});
+    bind(Action::WriteTrace, {Scancode::F4});
+    bind(Action::Quit, {Scancode::Escape});
+}
+
+void InputBindings::bind(Action action, std::vector<Scancode> newKeys) {
+    keys[static_cast<size_t>(action)] = std::move(newKeys);
+}
+
+const std::vector<Scancode>& InputBindings::keysFor(Action action) const {
+    return keys[static_cast<size_t>(action)];
+}
+
+const char* InputBindings::actionName(Action action) {
+    switch (action) {
+        case Action::PanLeft: return "PanLeft";
+        case Action::PanRight: return "PanRight";
+        case Action::PanUp: return "PanUp";
+        case Action::PanDown: return "PanDown";
+        case Action::ZoomIn: return "ZoomIn";
+        case Action::ZoomOut: return "ZoomOut";
+        case Action::Regenerate: return "Regenerate";
+        case Action::ToggleProfiler: return "ToggleProfiler";
+        case Action::WriteTrace: return "WriteTrace";
+        case Action::Quit: return "Quit";
+        default: return "?";
+    }
+}
+
+bool InputBindings::loadConfig(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Controls config " << path << " not found, using default keys\n";
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) continue;
+
+        std::istringstream nameStream(line.substr(0, equals));
+        std::string name;
+        nameStream >> name;
+
+        int action = 0;
+        while (action < static_cast<int>(Action::Count) && name != actionName(static_cast<Action>(action))) ++action;
+        if (action == static_cast<int>(Action::Count)) {
+            std::cerr << path << ":" << lineNumber << ": unknown action '" << name << "'\n";
+            continue;
+        }
+
+        std::vector<Scancode> newKeys;
+        std::istringstream keyStream(line.substr(equals + 1));
+        std::string key;
+        while (keyStream >> key) {
+            auto it = scancodeNames().find(key);
+            if (it == scancodeNames().end()) {
+                std::cerr << path << ":" << lineNumber << ": unknown key '" << key << "'\n";
+            } else {
+                newKeys.push_back(it->second);
+            }
+        }
+        if (!newKeys.empty()) bind(static_cast<Action>(action), newKeys);
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+enum class Action {
+    PanLeft,
+    PanRight,
+    PanUp,
+    PanDown,
+    ZoomIn,
+    ZoomOut,
+    Regenerate,
+    ToggleProfiler,
+    WriteTrace,
+    Quit,
+    Count
+};
+
+// Which keys trigger which action. Defaults match the original controls;
+// loadConfig overrides them from lines like "PanLeft = A Left".
+class InputBindings {
+public:
+    InputBindings();
+
+    // Unknown actions or keys are reported and skipped; returns false if the file can't be read
+    bool loadConfig(const std::string& path);
+
+    void bind(Action action, std::vector<sf::Keyboard::Scancode> keys);
+    const std::vector<sf::Keyboard::Scancode>& keysFor(Action action) const;
+
+    static const char* actionName(Action action);
+
+private:
+    std::array<std::vector<sf::Keyboard::Scancode>, static_cast<size_t>(Action::Count)> keys;
+};
@@ -0,0 +1,119 @@
+#include "InputSystem.hpp"
+#include "Profiler.hpp"
+
+InputSystem::InputSystem(UILayer& ui, const InputBindings& bindings) : ui(ui), bindings(bindings) {
+    pressed.fill(UILayer::None);
+}
+
+UILayer::WidgetId InputSystem::widgetAt(sf::Vector2i pixel, const sf::RenderWindow& window, const sf::View& worldView) {
+    return ui.hitTest(window.mapPixelToCoords(pixel, window.getDefaultView()),
+                      window.mapPixelToCoords(pixel, worldView));
+}
+
+bool InputSystem::handleEvent(const sf::Event& event, const sf::RenderWindow& window, const sf::View& worldView) {
+    if (const auto* key = event.getIf<sf::Event::KeyPressed>()) {
+        auto index = static_cast<std::size_t>(key->scancode);
+        if (index < KeyCount) {
+            // Key repeat sends more presses; only the first counts as "pressed"
+            if (!keysDown.test(index)) keysPressed.set(index);
+            keysDown.set(index);
+        }
+        return false;
+    }
+
+    if (const auto* key = event.getIf<sf::Event::KeyReleased>()) {
+        auto index = static_cast<std::size_t>(key->scancode);
+        if (index < KeyCount) keysDown.reset(index);
+        return false;
+    }
+
+    // Releases that happen while unfocused never arrive, so drop everything
+    if (event.is<sf::Event::FocusLost>()) {
+        keysDown.reset();
+        keysPressed.reset();
+        return false;
+    }
+
+    if (const auto* moved = event.getIf<sf::Event::MouseMoved>()) {
+        mousePixel = moved->position;
+        mouseInside = true;
+        hovered = widgetAt(mousePixel, window, worldView);
+        ui.setHovered(hovered);
+        return false;
+    }
+
+    if (event.is<sf::Event::MouseLeft>()) {
+        mouseInside = false;
+        hovered = UILayer::None;
+        ui.setHovered(hovered);
+        return false;
+    }
+
+    if (const auto* press = event.getIf<sf::Event::MouseButtonPressed>()) {
+        mousePixel = press->position;
+        UILayer::WidgetId target = widgetAt(mousePixel, window, worldView);
+        pressed[static_cast<std::size_t>(press->button)] = target;
+        if (target == UILayer::None) return false;
+        ui.press(target, press->button);
+        return true;
+    }
+
+    if (const auto* release = event.getIf<sf::Event::MouseButtonReleased>()) {
+        mousePixel = release->position;
+        UILayer::WidgetId& owner = pressed[static_cast<std::size_t>(release->button)];
+        UILayer::WidgetId target = widgetAt(mousePixel, window, worldView);
+        if (owner == UILayer::None) return false;
+
+        // The release always goes to the widget that saw the press
+        UILayer::WidgetId pressedWidget = owner;
+        owner = UILayer::None;
+        ui.release(pressedWidget, release->button);
+        if (target == pressedWidget) ui.click(pressedWidget, release->button);
+        return true;
+    }
+
+    return false;
+}
+
+void InputSystem::update(const sf::RenderWindow& window, const sf::View& worldView) {
+    PROFILE_SCOPE("InputSystem::update");
+    if (!mouseInside) return;
+    hovered = widgetAt(mousePixel, window, worldView);
+    ui.setHovered(hovered);
+}
+
+void InputSystem::beginFrame() {
+    keysPressed.reset();
+}
+
+bool InputSystem::anyKey(const std::bitset<KeyCount>& keys, Action action) const {
+    for (sf::Keyboard::Scancode key : bindings.keysFor(action)) {
+        auto index = static_cast<std::size_t>(key);
+        if (index < KeyCount && keys.test(index)) return true;
+    }
+    return false;
+}
+
+bool InputSystem::isActionDown(Action action) const {
+    return anyKey(keysDown, action);
+}
+
+bool InputSystem::wasActionPressed(Action action) const {
+    return anyKey(keysPressed, action);
+}
+
+float InputSystem::axis(Action negative, Action positive) const {
+    return (isActionDown(positive) ? 1.f : 0.f) - (isActionDown(negative) ? 1.f : 0.f);
+}
+
+sf::Vector2i InputSystem::getMousePixel() const {
+    return mousePixel;
+}
+
+bool InputSystem::isMouseInside() const {
+    return mouseInside;
+}
+
+bool InputSystem::isPointerOverUI() const {
+    return hovered != UILayer::None;
+}
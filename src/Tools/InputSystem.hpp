@@ -0,0 +1,49 @@
+#pragma once
+
+#include "InputBindings.hpp"
+#include "UILayer.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <bitset>
+
+// Consumes window events and dispatches press, release and click to widgets.
+// The mouse position is mapped to screen and world coordinates once per event
+// and the widget under it is found through the UILayer's hit index, so nothing
+// polls the mouse per widget. A click is a press and release on the same widget.
+// Keys are held in a fixed bitset indexed by scancode and read through bindings.
+class InputSystem {
+public:
+    InputSystem(UILayer& ui, const InputBindings& bindings);
+
+    // Returns true if a widget took the event; the game should ignore it then
+    bool handleEvent(const sf::Event& event, const sf::RenderWindow& window, const sf::View& worldView);
+    // Once per frame, after the camera moves, so hover follows the map under a still mouse
+    void update(const sf::RenderWindow& window, const sf::View& worldView);
+
+    // Clears the pressed-this-frame keys; call before polling events
+    void beginFrame();
+    bool isActionDown(Action action) const;
+    bool wasActionPressed(Action action) const;
+    // -1, 0 or 1 from a pair of opposing actions
+    float axis(Action negative, Action positive) const;
+
+    sf::Vector2i getMousePixel() const;
+    bool isMouseInside() const;
+    bool isPointerOverUI() const;
+
+private:
+    UILayer::WidgetId widgetAt(sf::Vector2i pixel, const sf::RenderWindow& window, const sf::View& worldView);
+
+    static constexpr std::size_t KeyCount = static_cast<std::size_t>(sf::Keyboard::ScancodeCount);
+    bool anyKey(const std::bitset<KeyCount>& keys, Action action) const;
+
+    UILayer& ui;
+    const InputBindings& bindings;
+    std::bitset<KeyCount> keysDown;
+    std::bitset<KeyCount> keysPressed;
+    sf::Vector2i mousePixel;
+    bool mouseInside = false;
+    UILayer::WidgetId hovered = UILayer::None;
+    std::array<UILayer::WidgetId, sf::Mouse::ButtonCount> pressed;
+};
@@ -1,5 +1,4 @@
 #include "ObjectTools.hpp"
-#include "UITools.hpp"
 
 #include <iostream>
 
@@ -1,6 +1,5 @@
 #pragma once
 #include <SFML/Graphics.hpp>
-#include "UITools.hpp"
 
 sf::RectangleShape placeObjectAt(int row, int col, float cellSize, sf::Color color);
 
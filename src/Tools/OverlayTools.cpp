@@ -0,0 +1,213 @@
+#include "OverlayTools.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <random>
+
+sf::Color getTileColor(int tileType) {
+    switch (tileType) {
+        case 0: return sf::Color::Blue;                     // Sea
+        // case 1: return sf::Color::Green;                    // Land
+        case 1: return {154, 255, 0};                    // Land
+        case 2: return {165, 217, 117};                     // Hills
+        case 3: return {169, 169, 169};                     // Mountain
+        case 5: return sf::Color::Red;                      // River source
+        // case 6: return {0, 128, 255};                       // River
+        case 6: return {0, 94, 255};                       // River
+        case 7: return sf::Color::White;                    // Ice
+        case 8: return {149, 158, 133};                     // Tundra
+        case 9: return {191, 201, 171};                     // Tundra hills
+        case 10: return {70, 97, 24};                       // Taiga
+        case 11: return {109, 148, 41};                     // Taiga hills
+        case 12: return {255, 236, 91};                     // Desert
+        case 13: return {224, 181, 81};                     // Desert hills
+        case 14: return sf::Color::Red;                     // River source again?
+        case 15: return sf::Color::White;                   // Ice cap
+        // case 16: return {2, 113, 224};                      // Lake
+        case 16: return {0, 94, 255};                      // Lake
+        case 17: return {137, 227, 0};                       // Floodplain
+        case 18: return {1, 51, 3};                         // Forest
+        case 19: return {3, 107, 7};                        // Forest hills
+        case 20: return {29, 173, 39};                      // Jungle
+        case 21: return {36, 212, 48};                      // Jungle hills
+        case 22: return {0, 94, 255};                      // Coast
+        case 23: return sf::Color(22, 0, 224);              // Ocean
+        // case 22: return {54, 73, 227};                      // Coast
+        default: return sf::Color::Magenta;                // Unknown / debug
+    }
+}
+
+
+std::vector<sf::Color> createTerrainColors(const std::vector<std::vector<int>>& map, unsigned int seed) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = rows > 0 ? static_cast<int>(map[0].size()) : 0;
+    std::vector<sf::Color> colors(rows * cols);
+
+    // Dappling is seeded from the map so the same seed always looks the same
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> offsetDist(-15, 15); // Small color variation
+
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            // Base color from tile type
+            sf::Color baseColor = getTileColor(map[row][col]);
+
+            // Dappling: slight random offset per RGB channel
+            int r = std::clamp(baseColor.r + offsetDist(gen), 0, 255);
+            int g = std::clamp(baseColor.g + offsetDist(gen), 0, 255);
+            int b = std::clamp(baseColor.b + offsetDist(gen), 0, 255);
+            colors[row * cols + col] = sf::Color(r, g, b);
+        }
+    }
+
+    return colors;
+}
+
+
+sf::VertexArray createTerrainGrid(const std::vector<std::vector<int>>& map, float cellSize, unsigned int seed) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = rows > 0 ? static_cast<int>(map[0].size()) : 0;
+
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles);
+    vertices.resize(rows * cols * 6); // 2 triangles per cell, 3 vertices each
+
+    std::vector<sf::Color> colors = createTerrainColors(map, seed);
+
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            float x = col * cellSize;
+            float y = row * cellSize;
+            sf::Color color = colors[row * cols + col];
+
+            int i = (row * cols + col) * 6;
+
+            vertices[i + 0].position = sf::Vector2f(x, y);
+            vertices[i + 0].color = color;
+
+            vertices[i + 1].position = sf::Vector2f(x + cellSize, y);
+            vertices[i + 1].color = color;
+
+            vertices[i + 2].position = sf::Vector2f(x, y + cellSize);
+            vertices[i + 2].color = color;
+
+            vertices[i + 3].position = sf::Vector2f(x, y + cellSize);
+            vertices[i + 3].color = color;
+
+            vertices[i + 4].position = sf::Vector2f(x + cellSize, y);
+            vertices[i + 4].color = color;
+
+            vertices[i + 5].position = sf::Vector2f(x + cellSize, y + cellSize);
+            vertices[i + 5].color = color;
+        }
+    }
+
+    return vertices;
+}
+
+
+sf::VertexArray createFertilityOverlay(const FertilityMap& fertility, float cellSize) {
+    const std::vector<std::vector<float>>& fertilityGrid = fertility.getFertilityGrid();
+    const int rows = static_cast<int>(fertilityGrid.size());
+    const int cols = rows > 0 ? static_cast<int>(fertilityGrid[0].size()) : 0;
+
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles);
+    vertices.resize(rows * cols * 6);
+
+    // We'll map fertility (0.0 to 1.0) to color from brown (low) to green (high)
+    auto fertilityToColor = [](float fert) -> sf::Color {
+        // clamp fert to [0,10]
+        fert = std::clamp(fert, 0.0f, 5.0f);
+        // Interpolate between brown (128, 64, 0) and green (0, 255, 0)
+        int r = static_cast<int>(128 * (1.0f - fert));
+        int g = static_cast<int>(64 + (255 - 64) * fert);
+        int b = 0;
+        return sf::Color(r, g, b, 100);  // semi-transparent alpha
+    };
+
+    // If fertility grid stores ints (0-100), normalize to 0-1 first:
+    // float fertNorm = fertilityValue / 100.0f;
+
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            float x = col * cellSize;
+            float y = row * cellSize;
+
+            float fertValue = fertilityGrid[row][col]; // your fertility value here, float 0-1 or int normalized
+            float fertNorm = fertValue / 1.0f;       // normalize if fertilityGrid is 0-100
+
+            sf::Color color = fertilityToColor(fertNorm);
+
+            int i = (row * cols + col) * 6;
+
+            vertices[i + 0].position = sf::Vector2f(x, y);
+            vertices[i + 0].color = color;
+
+            vertices[i + 1].position = sf::Vector2f(x + cellSize, y);
+            vertices[i + 1].color = color;
+
+            vertices[i + 2].position = sf::Vector2f(x, y + cellSize);
+            vertices[i + 2].color = color;
+
+            vertices[i + 3].position = sf::Vector2f(x, y + cellSize);
+            vertices[i + 3].color = color;
+
+            vertices[i + 4].position = sf::Vector2f(x + cellSize, y);
+            vertices[i + 4].color = color;
+
+            vertices[i + 5].position = sf::Vector2f(x + cellSize, y + cellSize);
+            vertices[i + 5].color = color;
+        }
+    }
+
+    return vertices;
+}
+
+
+sf::VertexArray createFogOverlay(const FogOfWarMap& fog, float cellSize) {
+    PROFILE_SCOPE("createFogOverlay");
+    const std::vector<std::vector<int>>& fogGrid = fog.getFogGrid();
+    const int rows = fog.getRows();
+    const int cols = fog.getCols();
+
+    sf::VertexArray vertices(sf::PrimitiveType::Triangles);
+    vertices.resize(rows * cols * 6);
+
+    auto fogToColor = [](int fogVal) -> sf::Color {
+        switch (fogVal) {
+            case 0: return sf::Color(0, 0, 0, 255);   // Black (full fog)
+            case 1: return sf::Color(100, 100, 100, 150); // Greyed out
+            case 2: return sf::Color(0, 0, 0, 0);     // Transparent (visible)
+            default: return sf::Color(255, 0, 255, 255); // Debug magenta
+        }
+    };
+
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            float x = col * cellSize;
+            float y = row * cellSize;
+
+            sf::Color color = fogToColor(fogGrid[row][col]);
+            int i = (row * cols + col) * 6;
+
+            vertices[i + 0].position = sf::Vector2f(x, y);
+            vertices[i + 0].color = color;
+
+            vertices[i + 1].position = sf::Vector2f(x + cellSize, y);
+            vertices[i + 1].color = color;
+
+            vertices[i + 2].position = sf::Vector2f(x, y + cellSize);
+            vertices[i + 2].color = color;
+
+            vertices[i + 3].position = sf::Vector2f(x, y + cellSize);
+            vertices[i + 3].color = color;
+
+            vertices[i + 4].position = sf::Vector2f(x + cellSize, y);
+            vertices[i + 4].color = color;
+
+            vertices[i + 5].position = sf::Vector2f(x + cellSize, y + cellSize);
+            vertices[i + 5].color = color;
+        }
+    }
+
+    return vertices;
+}
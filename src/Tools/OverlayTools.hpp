@@ -0,0 +1,18 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "../mechanics/Fertility.hpp"
+#include "../mechanics/FoW.hpp"
+
+// Base colour for a terrain tile type
+sf::Color getTileColor(int tileType);
+
+// Dappled colour of every tile, row-major; the dappling is seeded so a map always looks the same
+std::vector<sf::Color> createTerrainColors(const std::vector<std::vector<int>>& map, unsigned int seed);
+
+// Two triangles per tile, dappled per tile from the seed so a map always looks the same
+sf::VertexArray createTerrainGrid(const std::vector<std::vector<int>>& map, float cellSize, unsigned int seed);
+
+sf::VertexArray createFertilityOverlay(const FertilityMap& fertility, float cellSize);
+sf::VertexArray createFogOverlay(const FogOfWarMap& fog, float cellSize);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Calls body(i) for every i in [0, count) using up to `threads` threads
+// (0 = one per hardware thread). Indices are handed out one at a time, so
+// uneven work balances itself. The calling thread takes part.
+template <typename Body>
+void parallelFor(int count, int threads, Body&& body) {
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, count);
+
+    std::atomic<int> next{0};
+    auto work = [&]() {
+        for (int i = next++; i < count; i = next++) body(i);
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto& thread : pool) thread.join();
+}
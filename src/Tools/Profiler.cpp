@@ -0,0 +1,251 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+static constexpr std::size_t EventCapacity = 16384;  // per thread
+static constexpr std::size_t FrameCapacity = 600;
+static constexpr std::size_t RetiredThreadLimit = 8; // buffers kept after their thread exits
+
+struct ThreadBuffer {
+    std::mutex mutex;               // only contended while the overlay or an export reads
+    std::vector<ProfileEvent> events;
+    std::size_t next = 0;
+    bool wrapped = false;
+    int threadId = 0;
+    std::string threadName;
+    bool retired = false;
+};
+
+struct FrameRecord {
+    long long endNs;
+    long long durationNs;
+    long long drawCalls;
+    long long vertices;
+};
+
+static std::atomic<bool> enabled{false};
+static const auto epoch = std::chrono::steady_clock::now();
+
+static std::mutex registryMutex;
+static std::deque<std::shared_ptr<ThreadBuffer>> registry;
+static int nextThreadId = 1;
+
+static std::mutex internMutex;
+static std::set<std::string> internedNames; // node based, so c_str() stays valid
+
+static std::mutex frameMutex;
+static std::deque<FrameRecord> frameHistory;
+static long long lastFrameEndNs = 0;
+static std::atomic<long long> frameDrawCalls{0};
+static std::atomic<long long> frameVertices{0};
+
+// Registers the thread's buffer on first use and retires it when the thread exits
+struct ThreadBufferOwner {
+    std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+
+    ThreadBufferOwner() {
+        buffer->events.resize(EventCapacity);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->threadId = nextThreadId++;
+        registry.push_back(buffer);
+    }
+    ~ThreadBufferOwner() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->retired = true;
+        std::size_t retiredCount = std::count_if(registry.begin(), registry.end(),
+                                                 [](const auto& b) { return b->retired; });
+        for (auto it = registry.begin(); it != registry.end() && retiredCount > RetiredThreadLimit;) {
+            if ((*it)->retired) {
+                it = registry.erase(it);
+                --retiredCount;
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
+static ThreadBuffer& threadBuffer() {
+    static thread_local ThreadBufferOwner owner;
+    return *owner.buffer;
+}
+
+static std::vector<std::shared_ptr<ThreadBuffer>> registeredBuffers() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return {registry.begin(), registry.end()};
+}
+
+// Copies a buffer's events out in recording order
+static std::vector<ProfileEvent> snapshot(ThreadBuffer& buffer) {
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    std::vector<ProfileEvent> events;
+    if (buffer.wrapped) {
+        events.insert(events.end(), buffer.events.begin() + buffer.next, buffer.events.end());
+    }
+    events.insert(events.end(), buffer.events.begin(), buffer.events.begin() + buffer.next);
+    return events;
+}
+
+void Profiler::setEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+const char* Profiler::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(internMutex);
+    return internedNames.insert(name).first->c_str();
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+long long Profiler::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+int& Profiler::threadDepth() {
+    static thread_local int depth = 0;
+    return depth;
+}
+
+void Profiler::record(const char* name, long long startNs, long long durationNs, int depth) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.next] = {name, startNs, durationNs, depth};
+    if (++buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+void Profiler::endFrame() {
+    long long now = nowNs();
+    std::lock_guard<std::mutex> lock(frameMutex);
+    if (lastFrameEndNs != 0 && isEnabled()) {
+        frameHistory.push_back({now, now - lastFrameEndNs, frameDrawCalls.load(), frameVertices.load()});
+        if (frameHistory.size() > FrameCapacity) frameHistory.pop_front();
+    }
+    lastFrameEndNs = now;
+    frameDrawCalls = 0;
+    frameVertices = 0;
+}
+
+void Profiler::countDraw(std::size_t vertices) {
+    if (!isEnabled()) return;
+    frameDrawCalls.fetch_add(1, std::memory_order_relaxed);
+    frameVertices.fetch_add(static_cast<long long>(vertices), std::memory_order_relaxed);
+}
+
+FrameSummary Profiler::summarizeFrames(int frames) {
+    std::vector<FrameRecord> recent;
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        std::size_t count = std::min<std::size_t>(frameHistory.size(), static_cast<std::size_t>(std::max(frames, 0)));
+        recent.assign(frameHistory.end() - count, frameHistory.end());
+    }
+
+    FrameSummary summary;
+    summary.frames = static_cast<int>(recent.size());
+    if (recent.empty()) return summary;
+
+    std::vector<double> millis;
+    for (const FrameRecord& frame : recent) {
+        millis.push_back(frame.durationNs / 1e6);
+        summary.averageMillis += frame.durationNs / 1e6;
+        summary.drawCalls += frame.drawCalls;
+        summary.vertices += frame.vertices;
+    }
+    summary.averageMillis /= recent.size();
+    summary.drawCalls /= recent.size();
+    summary.vertices /= recent.size();
+
+    std::sort(millis.begin(), millis.end());
+    std::size_t p99 = std::min(millis.size() - 1, static_cast<std::size_t>(millis.size() * 0.99));
+    summary.p99Millis = millis[p99];
+    summary.maxMillis = millis.back();
+    return summary;
+}
+
+std::vector<ScopeSummary> Profiler::summarizeScopes(int frames) {
+    long long windowStartNs = 0;
+    int frameCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        std::size_t count = std::min<std::size_t>(frameHistory.size(), static_cast<std::size_t>(std::max(frames, 0)));
+        if (count == 0) return {};
+        const FrameRecord& first = frameHistory[frameHistory.size() - count];
+        windowStartNs = first.endNs - first.durationNs;
+        frameCount = static_cast<int>(count);
+    }
+
+    std::map<const char*, std::pair<long long, long long>> totals; // name -> (ns, calls)
+    for (const auto& buffer : registeredBuffers()) {
+        for (const ProfileEvent& event : snapshot(*buffer)) {
+            if (event.startNs < windowStartNs) continue;
+            auto& total = totals[event.name];
+            total.first += event.durationNs;
+            ++total.second;
+        }
+    }
+
+    std::vector<ScopeSummary> scopes;
+    for (const auto& [name, total] : totals) {
+        scopes.push_back({name, total.first / 1e6 / frameCount, static_cast<double>(total.second) / frameCount});
+    }
+    std::sort(scopes.begin(), scopes.end(),
+              [](const ScopeSummary& a, const ScopeSummary& b) { return a.millisPerFrame > b.millisPerFrame; });
+    return scopes;
+}
+
+static void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : registeredBuffers()) {
+        std::string threadName;
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            threadName = buffer->threadName.empty() ? "thread " + std::to_string(buffer->threadId)
+                                                    : buffer->threadName;
+        }
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->threadId << ",\"args\":{\"name\":";
+        writeJsonString(out, threadName);
+        out << "}}";
+        first = false;
+
+        for (const ProfileEvent& event : snapshot(*buffer)) {
+            out << ",\n{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Lightweight scoped instrumentation.
+//
+//   PROFILE_SCOPE("draw grid");
+//
+// Each thread records into its own ring buffer, so scopes never contend with
+// each other. While the profiler is disabled a scope costs one relaxed atomic
+// load; building with GRIDGAME_NO_PROFILING removes scopes entirely.
+
+struct ProfileEvent {
+    const char* name;      // string literal or Profiler::intern result
+    long long startNs;     // since the profiler started
+    long long durationNs;
+    int depth;             // nesting level on its thread
+};
+
+// Rolling average of one scope name over the summary window
+struct ScopeSummary {
+    const char* name;
+    double millisPerFrame;
+    double callsPerFrame;
+};
+
+struct FrameSummary {
+    int frames = 0;
+    double averageMillis = 0.0;
+    double p99Millis = 0.0;
+    double maxMillis = 0.0;
+    double drawCalls = 0.0;    // per frame
+    double vertices = 0.0;     // per frame
+};
+
+class Profiler {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // Names used in ring buffers must outlive them; use this for runtime strings
+    static const char* intern(const std::string& name);
+    // Label for the calling thread in trace exports
+    static void setThreadName(const std::string& name);
+
+    static long long nowNs();
+    static void record(const char* name, long long startNs, long long durationNs, int depth);
+    static int& threadDepth();
+
+    // Called once per rendered frame; closes the frame's draw counters
+    static void endFrame();
+    static void countDraw(std::size_t vertices);
+
+    // Averages over the last `frames` frames
+    static FrameSummary summarizeFrames(int frames);
+    static std::vector<ScopeSummary> summarizeScopes(int frames);
+
+    // Chrome trace format (chrome://tracing, Perfetto). Returns false if the file can't be written.
+    static bool writeChromeTrace(const std::string& path);
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) {
+        if (Profiler::isEnabled()) {
+            this->name = name;
+            depth = Profiler::threadDepth()++;
+            startNs = Profiler::nowNs();
+        }
+    }
+    ~ProfileScope() {
+        if (name) {
+            Profiler::record(name, startNs, Profiler::nowNs() - startNs, depth);
+            --Profiler::threadDepth();
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name = nullptr;
+    long long startNs = 0;
+    int depth = 0;
+};
+
+#ifdef GRIDGAME_NO_PROFILING
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#endif
@@ -0,0 +1,78 @@
+#include "ProfilerOverlay.hpp"
+#include "Profiler.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+static const int SummaryFrames = 120;   // rolling window, about two seconds
+static const size_t ScopeLines = 12;
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font& font) : text(font, "", 16) {
+    background.setPosition({10.f, 10.f});
+    background.setFillColor(sf::Color(0, 0, 0, 180));
+    text.setPosition({20.f, 16.f});
+    text.setFillColor(sf::Color::White);
+}
+
+void ProfilerOverlay::toggle() {
+    visible = !visible;
+    Profiler::setEnabled(visible);
+    text.setString("Collecting...");
+    refreshClock.restart();
+}
+
+bool ProfilerOverlay::isVisible() const {
+    return visible;
+}
+
+void ProfilerOverlay::refresh() {
+    FrameSummary frames = Profiler::summarizeFrames(SummaryFrames);
+    std::vector<ScopeSummary> scopes = Profiler::summarizeScopes(SummaryFrames);
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "frame " << frames.averageMillis << " ms   p99 " << frames.p99Millis
+        << " ms   max " << frames.maxMillis << " ms   ("
+        << std::setprecision(0) << (frames.averageMillis > 0.0 ? 1000.0 / frames.averageMillis : 0.0) << " fps)\n";
+    out << "draws " << frames.drawCalls << "   vertices " << frames.vertices << "\n\n";
+    out << std::setprecision(2);
+    for (size_t i = 0; i < scopes.size() && i < ScopeLines; ++i) {
+        out << std::setw(7) << scopes[i].millisPerFrame << " ms  x" << std::setprecision(1)
+            << scopes[i].callsPerFrame << "  " << scopes[i].name << "\n" << std::setprecision(2);
+    }
+    text.setString(out.str());
+
+    sf::FloatRect bounds = text.getLocalBounds();
+    background.setSize({bounds.size.x + 30.f, bounds.size.y + 30.f});
+}
+
+void ProfilerOverlay::draw(sf::RenderWindow& window) {
+    if (!visible) return;
+    if (refreshClock.getElapsedTime().asSeconds() > 0.25f) {
+        refresh();
+        refreshClock.restart();
+    }
+
+    sf::View previous = window.getView();
+    window.setView(window.getDefaultView());
+    window.draw(background);
+    window.draw(text);
+    window.setView(previous);
+}
+
+void drawCounted(sf::RenderTarget& target, const sf::VertexArray& vertices) {
+    target.draw(vertices);
+    Profiler::countDraw(vertices.getVertexCount());
+}
+
+void drawCounted(sf::RenderTarget& target, const sf::Shape& shape) {
+    target.draw(shape);
+    // Fill fan, plus the outline strip when there is one
+    std::size_t points = shape.getPointCount();
+    Profiler::countDraw(points + 2 + (shape.getOutlineThickness() != 0.f ? 2 * points + 2 : 0));
+}
+
+void drawCounted(sf::RenderTarget& target, const sf::Text& text) {
+    target.draw(text);
+    Profiler::countDraw(text.getString().getSize() * 6);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+// Screen-space panel with frame time, p99, draw counts and the slowest scopes.
+// The text is rebuilt a few times a second, not every frame.
+class ProfilerOverlay {
+public:
+    explicit ProfilerOverlay(const sf::Font& font);
+
+    // Showing the overlay also turns recording on; hiding it turns recording off
+    void toggle();
+    bool isVisible() const;
+
+    void draw(sf::RenderWindow& window);
+
+private:
+    void refresh();
+
+    bool visible = false;
+    sf::RectangleShape background;
+    sf::Text text;
+    sf::Clock refreshClock;
+};
+
+// window.draw that also counts draw calls and vertices for the overlay
+void drawCounted(sf::RenderTarget& target, const sf::VertexArray& vertices);
+void drawCounted(sf::RenderTarget& target, const sf::Shape& shape);
+void drawCounted(sf::RenderTarget& target, const sf::Text& text);
@@ -0,0 +1,90 @@
+#include "ScratchArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+ScratchArena::ScratchArena(std::size_t initialBytes) {
+    if (initialBytes > 0) addBlock(initialBytes);
+}
+
+ScratchArena::~ScratchArena() {
+    freeBlocks();
+}
+
+// Blocks come from plain operator new so the allocation counter sees them
+void ScratchArena::addBlock(std::size_t size) {
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = head;
+    block->size = size;
+    head = block;
+    cursor = reinterpret_cast<char*>(block + 1);
+    limit = cursor + size;
+    held += size;
+#ifndef NDEBUG
+    ++stats.blocks;
+#endif
+}
+
+void ScratchArena::freeBlocks() {
+    while (head) {
+        Block* next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+    cursor = limit = nullptr;
+    held = 0;
+}
+
+void* ScratchArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    auto alignUp = [alignment](char* p) {
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        return p + ((alignment - address % alignment) % alignment);
+    };
+
+    char* start = head ? alignUp(cursor) : nullptr;
+    if (!head || start > limit || static_cast<std::size_t>(limit - start) < bytes) {
+        // At least double what is held, so a growing workload needs few blocks
+        addBlock(std::max({bytes + alignment, MinBlockSize, held}));
+        start = alignUp(cursor);
+    }
+    used += static_cast<std::size_t>(start + bytes - cursor);
+    cursor = start + bytes;
+#ifndef NDEBUG
+    ++stats.allocations;
+    stats.bytes += static_cast<long long>(bytes);
+#endif
+    return start;
+}
+
+void ScratchArena::reset() {
+    // Several blocks means the last round outgrew the first; next time one will do
+    if (head && head->next) {
+        const std::size_t total = held;
+        freeBlocks();
+        addBlock(total);
+    } else if (head) {
+        cursor = reinterpret_cast<char*>(head + 1);
+        limit = cursor + head->size;
+    }
+    used = 0;
+#ifndef NDEBUG
+    ++stats.resets;
+#endif
+}
+
+std::size_t ScratchArena::bytesInUse() const {
+    return used;
+}
+
+std::size_t ScratchArena::capacity() const {
+    return held;
+}
+
+ScratchArena::Stats ScratchArena::getStats() const {
+#ifndef NDEBUG
+    return stats;
+#else
+    return {};
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Bump allocator for memory that is thrown away all at once, such as a
+// generation stage's temporaries. Use it through std::pmr containers
+// (std::pmr::vector<int> buffer(&arena)). Allocating bumps a pointer,
+// deallocating does nothing, and reset() frees everything. Blocks are kept
+// across resets and merged into one big enough for everything handed out
+// before the reset, so a warmed-up arena stops touching the heap. Not
+// thread-safe: give each thread its own.
+class ScratchArena : public std::pmr::memory_resource {
+public:
+    explicit ScratchArena(std::size_t initialBytes = 0);
+    ~ScratchArena() override;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // Frees everything handed out since the last reset; nothing may still be using it
+    void reset();
+
+    std::size_t bytesInUse() const; // handed out since the last reset, alignment padding included
+    std::size_t capacity() const;   // bytes held in blocks
+
+    // Counted in debug builds only; all zero with NDEBUG
+    struct Stats {
+        long long allocations = 0;
+        long long bytes = 0;
+        long long blocks = 0; // taken from the heap
+        long long resets = 0;
+    };
+    Stats getStats() const;
+
+private:
+    struct Block {
+        Block* next;
+        std::size_t size; // usable bytes after the header
+    };
+    static constexpr std::size_t MinBlockSize = 64 * 1024;
+
+    Block* head = nullptr; // the block being bumped; older blocks follow
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    std::size_t used = 0;
+    std::size_t held = 0;
+#ifndef NDEBUG
+    Stats stats;
+#endif
+
+    void addBlock(std::size_t size);
+    void freeBlocks();
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
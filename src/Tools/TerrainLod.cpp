@@ -0,0 +1,109 @@
+#include "TerrainLod.hpp"
+#include "OverlayTools.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void TerrainLod::build(const std::vector<std::vector<int>>& map, float newCellSize, unsigned int seed) {
+    cellSize = newCellSize;
+    images.clear();
+    textures.clear();
+    usable.clear();
+    uploaded = false;
+
+    const unsigned int rows = static_cast<unsigned int>(map.size());
+    const unsigned int cols = rows > 0 ? static_cast<unsigned int>(map[0].size()) : 0;
+    if (rows == 0 || cols == 0) return;
+
+    std::vector<sf::Color> colors = createTerrainColors(map, seed);
+    sf::Image base({cols, rows});
+    for (unsigned int row = 0; row < rows; ++row) {
+        for (unsigned int col = 0; col < cols; ++col) {
+            base.setPixel({col, row}, colors[row * cols + col]);
+        }
+    }
+    images.push_back(std::move(base));
+
+    // Average 2x2 blocks until a single texel is left; odd edges average what exists
+    while (images.back().getSize().x > 1 || images.back().getSize().y > 1) {
+        const sf::Image& fine = images.back();
+        sf::Vector2u fineSize = fine.getSize();
+        sf::Vector2u size = {(fineSize.x + 1) / 2, (fineSize.y + 1) / 2};
+        sf::Image coarse(size);
+        for (unsigned int y = 0; y < size.y; ++y) {
+            for (unsigned int x = 0; x < size.x; ++x) {
+                unsigned int r = 0, g = 0, b = 0, count = 0;
+                for (unsigned int dy = 0; dy < 2; ++dy) {
+                    for (unsigned int dx = 0; dx < 2; ++dx) {
+                        unsigned int fx = 2 * x + dx;
+                        unsigned int fy = 2 * y + dy;
+                        if (fx >= fineSize.x || fy >= fineSize.y) continue;
+                        sf::Color c = fine.getPixel({fx, fy});
+                        r += c.r;
+                        g += c.g;
+                        b += c.b;
+                        ++count;
+                    }
+                }
+                coarse.setPixel({x, y}, sf::Color(r / count, g / count, b / count));
+            }
+        }
+        images.push_back(std::move(coarse));
+    }
+}
+
+void TerrainLod::upload() {
+    const unsigned int maximum = sf::Texture::getMaximumSize();
+    textures.resize(images.size());
+    usable.assign(images.size(), false);
+    for (size_t i = 0; i < images.size(); ++i) {
+        sf::Vector2u size = images[i].getSize();
+        if (size.x > maximum || size.y > maximum) continue;
+        if (!textures[i].loadFromImage(images[i])) continue;
+        // Tiles stay crisp up close; coarser levels filter so they don't shimmer
+        textures[i].setSmooth(i > 0);
+        usable[i] = true;
+    }
+    uploaded = true;
+}
+
+void TerrainLod::draw(sf::RenderTarget& target, const sf::View& view) {
+    PROFILE_SCOPE("TerrainLod::draw");
+    if (images.empty()) return;
+    if (!uploaded) upload();
+
+    // Level where one texel covers about one screen pixel
+    const float pixelsPerTile = cellSize * target.getSize().x / view.getSize().x;
+    const int last = static_cast<int>(images.size()) - 1;
+    int first = 0;
+    while (first < last && !usable[first]) ++first;
+    level = std::clamp(std::log2(1.f / pixelsPerTile), static_cast<float>(first), static_cast<float>(last));
+
+    const int fine = static_cast<int>(level);
+    const int coarse = std::min(fine + 1, last);
+    const float blend = level - fine;
+
+    auto drawLevel = [&](int index, std::uint8_t alpha) {
+        if (!usable[index]) return;
+        sf::Sprite sprite(textures[index]);
+        const float texel = cellSize * static_cast<float>(1u << index);
+        sprite.setScale({texel, texel});
+        sprite.setColor(sf::Color(255, 255, 255, alpha));
+        target.draw(sprite);
+        Profiler::countDraw(4);
+    };
+
+    drawLevel(fine, 255);
+    if (coarse != fine && blend > 0.f) {
+        drawLevel(coarse, static_cast<std::uint8_t>(blend * 255.f));
+    }
+}
+
+int TerrainLod::getLevelCount() const {
+    return static_cast<int>(images.size());
+}
+
+float TerrainLod::getLevel() const {
+    return level;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Terrain drawn as a chain of textures: level 0 has one texel per tile (the same
+// dappled colours as createTerrainGrid), and every further level averages 2x2
+// texels of the one before. The level is picked from how many screen pixels a
+// tile covers, and the two nearest levels are crossfaded while zooming, so a
+// frame samples roughly one texel per pixel and submits a handful of vertices
+// at any zoom.
+class TerrainLod {
+public:
+    // CPU work only; safe on a worker thread
+    void build(const std::vector<std::vector<int>>& map, float cellSize, unsigned int seed);
+
+    // Uploads the textures on first use, so call it from the render thread
+    void draw(sf::RenderTarget& target, const sf::View& view);
+
+    int getLevelCount() const;
+    float getLevel() const; // fractional level used by the last draw
+
+private:
+    void upload();
+
+    float cellSize = 1.f;
+    std::vector<sf::Image> images;
+    std::vector<sf::Texture> textures;
+    std::vector<bool> usable;   // false where a level exceeds the GPU's texture size
+    bool uploaded = false;
+    float level = 0.f;
+};
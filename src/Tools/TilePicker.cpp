@@ -0,0 +1,58 @@
+#include "TilePicker.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+TilePicker::TilePicker(int rows, int cols, float cellSize)
+    : rows(rows), cols(cols), cellSize(cellSize), highlight({cellSize, cellSize}) {
+    highlight.setFillColor(sf::Color(255, 255, 0, 80)); // semi-transparent yellow
+    highlight.setOutlineColor(sf::Color::White);
+    highlight.setOutlineThickness(1.f);
+}
+
+TilePick TilePicker::pickWorld(sf::Vector2f world) const {
+    TilePick pick;
+    pick.world = world;
+    // floor, not truncation, so -0.5 is tile -1 (off the map) rather than tile 0
+    pick.row = static_cast<int>(std::floor(world.y / cellSize));
+    pick.col = static_cast<int>(std::floor(world.x / cellSize));
+    pick.valid = pick.row >= 0 && pick.row < rows && pick.col >= 0 && pick.col < cols;
+    return pick;
+}
+
+void TilePicker::update(const sf::RenderWindow& window, const sf::View& worldView, sf::Vector2i mousePixel, bool mouseInside) {
+    PROFILE_SCOPE("TilePicker::update");
+    TilePick previous = current;
+    if (mouseInside) {
+        current = pickWorld(window.mapPixelToCoords(mousePixel, worldView));
+    } else {
+        current = TilePick{};
+    }
+
+    if (current.valid && (current.row != previous.row || current.col != previous.col)) {
+        highlight.setPosition({current.col * cellSize, current.row * cellSize});
+    }
+}
+
+const TilePick& TilePicker::hovered() const {
+    return current;
+}
+
+const sf::RectangleShape& TilePicker::getHoverHighlight() const {
+    return highlight;
+}
+
+TileRect TilePicker::pickRect(sf::Vector2f cornerA, sf::Vector2f cornerB) const {
+    const float left = std::min(cornerA.x, cornerB.x);
+    const float right = std::max(cornerA.x, cornerB.x);
+    const float top = std::min(cornerA.y, cornerB.y);
+    const float bottom = std::max(cornerA.y, cornerB.y);
+
+    TileRect rect;
+    rect.rowBegin = std::max(0, static_cast<int>(std::floor(top / cellSize)));
+    rect.colBegin = std::max(0, static_cast<int>(std::floor(left / cellSize)));
+    rect.rowEnd = std::min(rows - 1, static_cast<int>(std::floor(bottom / cellSize)));
+    rect.colEnd = std::min(cols - 1, static_cast<int>(std::floor(right / cellSize)));
+    return rect;
+}
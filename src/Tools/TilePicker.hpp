@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+struct TilePick {
+    bool valid = false; // false when the cursor is off the map or outside the window
+    int row = -1;
+    int col = -1;
+    sf::Vector2f world;
+};
+
+// Inclusive range of tiles, already clamped to the map. Empty if rowEnd < rowBegin.
+struct TileRect {
+    int rowBegin = 0, colBegin = 0;
+    int rowEnd = -1, colEnd = -1;
+
+    bool empty() const { return rowEnd < rowBegin || colEnd < colBegin; }
+    bool contains(int row, int col) const {
+        return row >= rowBegin && row <= rowEnd && col >= colBegin && col <= colEnd;
+    }
+};
+
+// Maps the cursor to a tile once per frame and keeps the answer for everyone who
+// asks (hover highlight, map clicks, tooltips). Picks are bounds checked; a
+// cursor off the map gives an invalid pick instead of an out-of-range index.
+class TilePicker {
+public:
+    TilePicker(int rows, int cols, float cellSize);
+
+    // Call once per frame after the camera has moved
+    void update(const sf::RenderWindow& window, const sf::View& worldView, sf::Vector2i mousePixel, bool mouseInside);
+    const TilePick& hovered() const;
+    // Highlight for the hovered tile; only rebuilt when the tile changes
+    const sf::RectangleShape& getHoverHighlight() const;
+
+    TilePick pickWorld(sf::Vector2f world) const;
+    // Tiles touched by the world-space rectangle between two corners, in any order
+    TileRect pickRect(sf::Vector2f cornerA, sf::Vector2f cornerB) const;
+
+private:
+    int rows, cols;
+    float cellSize;
+    TilePick current;
+    sf::RectangleShape highlight;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free handoff of the newest value from one writer thread to one reader
+// thread. The writer fills back() and publish() swaps it with the middle slot;
+// the reader's acquire() swaps the middle slot into front() if anything new was
+// published. Neither side ever waits; the reader simply skips stale values.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    // Writer side
+    T& back() { return slots[backIndex]; }
+    void publish() {
+        unsigned int previous = middle.exchange(backIndex | FreshBit, std::memory_order_acq_rel);
+        backIndex = previous & IndexMask;
+    }
+
+    // Reader side. Returns true if front() now holds a newer value.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_acquire) & FreshBit)) return false;
+        unsigned int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & IndexMask;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr unsigned int IndexMask = 3;
+    static constexpr unsigned int FreshBit = 4;
+
+    T slots[3];
+    unsigned int backIndex = 0;              // writer only
+    std::atomic<unsigned int> middle{1};     // shared: slot index plus FreshBit
+    unsigned int frontIndex = 2;             // reader only
+};
@@ -0,0 +1,222 @@
+#include "UILayer.hpp"
+#include "Profiler.hpp"
+#include "ProfilerOverlay.hpp"
+
+// Fill quad plus four outline strips, two triangles each
+static const std::size_t VerticesPerWidget = 30;
+
+const UIStyle UILayer::PanelStyle = {sf::Color(50, 50, 50, 200), sf::Color(50, 50, 50, 200),
+                                     sf::Color::White, sf::Color::White, 2.f};
+const UIStyle UILayer::ButtonStyle = {sf::Color(200, 200, 200, 180), sf::Color(170, 170, 170, 180),
+                                      sf::Color::Black, sf::Color::Black, 2.f};
+
+UILayer::UILayer(const sf::Font& font) : font(font) {}
+
+UILayer::WidgetId UILayer::addWidget(UISpace space, sf::FloatRect rect, WidgetId parent, const UIStyle& style) {
+    WidgetId id = static_cast<WidgetId>(widgets.size());
+    Widget widget;
+    widget.space = space;
+    widget.parent = parent;
+    widget.localRect = rect;
+    widget.style = style;
+
+    sf::VertexArray& vertices = verticesFor(space);
+    widget.firstVertex = vertices.getVertexCount();
+    vertices.resize(widget.firstVertex + VerticesPerWidget);
+
+    widgets.push_back(std::move(widget));
+    if (parent != None) widgets[parent].children.push_back(id);
+    return id;
+}
+
+UILayer::WidgetId UILayer::addPanel(UISpace space, sf::FloatRect rect, WidgetId parent) {
+    WidgetId id = addWidget(space, rect, parent, PanelStyle);
+    relayout(id);
+    return id;
+}
+
+UILayer::WidgetId UILayer::addButton(UISpace space, sf::FloatRect rect, const std::string& label,
+                                     unsigned int fontSize, std::function<void()> onClick, WidgetId parent) {
+    WidgetId id = addWidget(space, rect, parent, ButtonStyle);
+    Widget& widget = widgets[id];
+    widget.isButton = true;
+    widget.onClick = std::move(onClick);
+    // Rendered at twice the size and scaled down, as the old buttons were, for sharper glyphs
+    widget.text.emplace(font, label, fontSize);
+    widget.text->setScale({widget.textScale, widget.textScale});
+    widget.text->setFillColor(widget.style.textColor);
+    relayout(id);
+    return id;
+}
+
+void UILayer::setPosition(WidgetId id, sf::Vector2f position) {
+    if (widgets[id].localRect.position == position) return;
+    widgets[id].localRect.position = position;
+    relayout(id);
+}
+
+void UILayer::setLabel(WidgetId id, const std::string& label) {
+    Widget& widget = widgets[id];
+    if (!widget.text || widget.text->getString() == sf::String(label)) return;
+    widget.text->setString(label);
+    placeText(widget);
+}
+
+void UILayer::setStyle(WidgetId id, const UIStyle& style) {
+    Widget& widget = widgets[id];
+    widget.style = style;
+    if (widget.text) widget.text->setFillColor(style.textColor);
+    writeVertices(widget);
+}
+
+void UILayer::setVisible(WidgetId id, bool visible) {
+    if (widgets[id].visible == visible) return;
+    widgets[id].visible = visible;
+    relayout(id);
+}
+
+bool UILayer::isVisible(WidgetId id) const {
+    return widgets[id].shown;
+}
+
+void UILayer::relayout(WidgetId id) {
+    Widget& widget = widgets[id];
+    if (widget.parent == None) {
+        widget.rect = widget.localRect;
+        widget.shown = widget.visible;
+    } else {
+        const Widget& parent = widgets[widget.parent];
+        widget.rect = {parent.rect.position + widget.localRect.position, widget.localRect.size};
+        widget.shown = widget.visible && parent.shown;
+    }
+    if (!widget.shown && widget.hovered) {
+        widget.hovered = false;
+        hoveredWidget = None;
+    }
+    hitsDirty = true;
+
+    writeVertices(widget);
+    placeText(widget);
+    for (WidgetId child : widget.children) relayout(child);
+}
+
+void UILayer::placeText(Widget& widget) {
+    if (!widget.text) return;
+    widget.text->setOrigin({0.f, 0.f});
+    sf::FloatRect bounds = widget.text->getLocalBounds();
+    widget.text->setOrigin(bounds.position + bounds.size / 2.f);
+    widget.text->setPosition(widget.rect.position + widget.rect.size / 2.f);
+}
+
+static void writeQuad(sf::VertexArray& vertices, std::size_t first, sf::Vector2f topLeft, sf::Vector2f size, sf::Color color) {
+    sf::Vector2f topRight = topLeft + sf::Vector2f(size.x, 0.f);
+    sf::Vector2f bottomLeft = topLeft + sf::Vector2f(0.f, size.y);
+    sf::Vector2f bottomRight = topLeft + size;
+    const sf::Vector2f corners[6] = {topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft};
+    for (int i = 0; i < 6; ++i) {
+        vertices[first + i].position = corners[i];
+        vertices[first + i].color = color;
+    }
+}
+
+void UILayer::writeVertices(const Widget& widget) {
+    sf::VertexArray& vertices = verticesFor(widget.space);
+    std::size_t first = widget.firstVertex;
+
+    if (!widget.shown) {
+        // Collapse to nothing; the slot stays reserved for when it is shown again
+        for (std::size_t i = 0; i < VerticesPerWidget; ++i) {
+            vertices[first + i].position = widget.rect.position;
+            vertices[first + i].color = sf::Color::Transparent;
+        }
+        return;
+    }
+
+    sf::Vector2f position = widget.rect.position;
+    sf::Vector2f size = widget.rect.size;
+    float t = widget.style.outlineThickness;
+
+    writeQuad(vertices, first, position, size, widget.hovered ? widget.style.hoverFill : widget.style.fill);
+    // Outline sits outside the rect, like sf::Shape's
+    writeQuad(vertices, first + 6, position - sf::Vector2f(t, t), {size.x + 2 * t, t}, widget.style.outline);
+    writeQuad(vertices, first + 12, position + sf::Vector2f(-t, size.y), {size.x + 2 * t, t}, widget.style.outline);
+    writeQuad(vertices, first + 18, position - sf::Vector2f(t, 0.f), {t, size.y}, widget.style.outline);
+    writeQuad(vertices, first + 24, position + sf::Vector2f(size.x, 0.f), {t, size.y}, widget.style.outline);
+}
+
+sf::VertexArray& UILayer::verticesFor(UISpace space) {
+    return space == UISpace::Screen ? screenVertices : worldVertices;
+}
+
+void UILayer::setOnPress(WidgetId id, std::function<void(sf::Mouse::Button)> handler) {
+    widgets[id].onPress = std::move(handler);
+}
+
+void UILayer::setOnRelease(WidgetId id, std::function<void(sf::Mouse::Button)> handler) {
+    widgets[id].onRelease = std::move(handler);
+}
+
+void UILayer::rebuildHitIndices() {
+    std::vector<HitIndex::Item> screenItems;
+    std::vector<HitIndex::Item> worldItems;
+    for (WidgetId id = 0; id < static_cast<WidgetId>(widgets.size()); ++id) {
+        const Widget& widget = widgets[id];
+        if (!widget.isButton || !widget.shown) continue;
+        (widget.space == UISpace::Screen ? screenItems : worldItems).push_back({id, widget.rect});
+    }
+    screenHits.build(std::move(screenItems));
+    worldHits.build(std::move(worldItems));
+    hitsDirty = false;
+}
+
+UILayer::WidgetId UILayer::hitTest(sf::Vector2f screenPoint, sf::Vector2f worldPoint) {
+    if (hitsDirty) rebuildHitIndices();
+    WidgetId found = screenHits.query(screenPoint);
+    return found != None ? found : worldHits.query(worldPoint);
+}
+
+void UILayer::setHovered(WidgetId id) {
+    if (id == hoveredWidget) return;
+    if (hoveredWidget != None) {
+        widgets[hoveredWidget].hovered = false;
+        writeVertices(widgets[hoveredWidget]);
+    }
+    if (id != None) {
+        widgets[id].hovered = true;
+        writeVertices(widgets[id]);
+    }
+    hoveredWidget = id;
+}
+
+void UILayer::press(WidgetId id, sf::Mouse::Button button) {
+    if (id != None && widgets[id].onPress) widgets[id].onPress(button);
+}
+
+void UILayer::release(WidgetId id, sf::Mouse::Button button) {
+    if (id != None && widgets[id].onRelease) widgets[id].onRelease(button);
+}
+
+void UILayer::click(WidgetId id, sf::Mouse::Button button) {
+    // Buttons act on left clicks; other buttons only reach the press/release handlers
+    if (id != None && button == sf::Mouse::Button::Left && widgets[id].shown && widgets[id].onClick) {
+        widgets[id].onClick();
+    }
+}
+
+void UILayer::draw(sf::RenderWindow& window, const sf::View& worldView) {
+    PROFILE_SCOPE("UILayer::draw");
+
+    window.setView(worldView);
+    drawCounted(window, worldVertices);
+    for (const Widget& widget : widgets) {
+        if (widget.space == UISpace::World && widget.shown && widget.text) drawCounted(window, *widget.text);
+    }
+
+    window.setView(window.getDefaultView());
+    drawCounted(window, screenVertices);
+    for (const Widget& widget : widgets) {
+        if (widget.space == UISpace::Screen && widget.shown && widget.text) drawCounted(window, *widget.text);
+    }
+
+    window.setView(worldView);
+}
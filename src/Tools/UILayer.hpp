@@ -0,0 +1,99 @@
+#pragma once
+
+#include "HitIndex.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Screen widgets are laid out in window pixels and drawn with the default view;
+// world widgets sit in map coordinates and move and zoom with the camera.
+enum class UISpace { Screen, World };
+
+struct UIStyle {
+    sf::Color fill;
+    sf::Color hoverFill;
+    sf::Color outline;
+    sf::Color textColor;
+    float outlineThickness;
+};
+
+// Retained UI: widgets are created once and keep their geometry. Changing a
+// widget (position, label, visibility, hover) rewrites only that widget's
+// vertices and text, and drawing is one vertex array per space plus the labels.
+class UILayer {
+public:
+    using WidgetId = int;
+    static constexpr WidgetId None = -1;
+
+    explicit UILayer(const sf::Font& font);
+
+    // Child rects are relative to their parent's top left corner
+    WidgetId addPanel(UISpace space, sf::FloatRect rect, WidgetId parent = None);
+    WidgetId addButton(UISpace space, sf::FloatRect rect, const std::string& label, unsigned int fontSize,
+                       std::function<void()> onClick, WidgetId parent = None);
+
+    void setPosition(WidgetId id, sf::Vector2f position);
+    void setLabel(WidgetId id, const std::string& label);
+    void setStyle(WidgetId id, const UIStyle& style);
+    // Hiding a widget hides its children too
+    void setVisible(WidgetId id, bool visible);
+    bool isVisible(WidgetId id) const;
+
+    // Optional handlers besides the left-click action given to addButton
+    void setOnPress(WidgetId id, std::function<void(sf::Mouse::Button)> handler);
+    void setOnRelease(WidgetId id, std::function<void(sf::Mouse::Button)> handler);
+
+    // Topmost visible button at the point; screen widgets are above world ones
+    WidgetId hitTest(sf::Vector2f screenPoint, sf::Vector2f worldPoint);
+    void setHovered(WidgetId id);
+
+    // Dispatch, normally driven by InputSystem
+    void press(WidgetId id, sf::Mouse::Button button);
+    void release(WidgetId id, sf::Mouse::Button button);
+    void click(WidgetId id, sf::Mouse::Button button = sf::Mouse::Button::Left);
+
+    void draw(sf::RenderWindow& window, const sf::View& worldView);
+
+    static const UIStyle PanelStyle;
+    static const UIStyle ButtonStyle;
+
+private:
+    struct Widget {
+        UISpace space;
+        WidgetId parent;
+        std::vector<WidgetId> children;
+        sf::FloatRect localRect;
+        sf::FloatRect rect;          // absolute, in its space
+        bool visible = true;         // own flag
+        bool shown = true;           // own flag and every ancestor's
+        bool hovered = false;
+        bool isButton = false;
+        UIStyle style;
+        std::optional<sf::Text> text;
+        float textScale = 0.5f;
+        std::function<void()> onClick;
+        std::function<void(sf::Mouse::Button)> onPress;
+        std::function<void(sf::Mouse::Button)> onRelease;
+        std::size_t firstVertex = 0; // slot in the space's vertex array
+    };
+
+    WidgetId addWidget(UISpace space, sf::FloatRect rect, WidgetId parent, const UIStyle& style);
+    // Recomputes rect and visibility of a widget and its subtree, then rewrites their geometry
+    void relayout(WidgetId id);
+    void writeVertices(const Widget& widget);
+    void placeText(Widget& widget);
+    sf::VertexArray& verticesFor(UISpace space);
+    void rebuildHitIndices();
+
+    const sf::Font& font;
+    std::vector<Widget> widgets;
+    sf::VertexArray screenVertices{sf::PrimitiveType::Triangles};
+    sf::VertexArray worldVertices{sf::PrimitiveType::Triangles};
+    WidgetId hoveredWidget = None;
+    HitIndex screenHits;
+    HitIndex worldHits;
+    bool hitsDirty = true;       // set by any layout or visibility change
+};
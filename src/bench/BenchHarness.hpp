@@ -0,0 +1,95 @@
+#pragma once
+
+// Minimal benchmark harness: runs a case a fixed number of times, keeps the
+// samples and writes them as a table or as JSON (one object per case) so runs
+// can be diffed and tracked for regressions.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+    std::string name;
+    int rows;
+    int cols;
+    std::vector<double> samplesMs;
+
+    double minMs() const { return *std::min_element(samplesMs.begin(), samplesMs.end()); }
+    double meanMs() const {
+        double sum = 0.0;
+        for (double s : samplesMs) sum += s;
+        return sum / samplesMs.size();
+    }
+    double medianMs() const {
+        std::vector<double> sorted = samplesMs;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[sorted.size() / 2];
+    }
+};
+
+class BenchHarness {
+public:
+    // Only cases whose name contains filter are run
+    explicit BenchHarness(std::string filter = "") : filter(std::move(filter)) {}
+
+    bool wants(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    // Times fn once per iteration; setup runs before each iteration and is not timed
+    void run(const std::string& name, int rows, int cols, int iterations,
+             const std::function<void()>& fn, const std::function<void()>& setup = {}) {
+        if (!wants(name)) return;
+        BenchResult result{name, rows, cols, {}};
+        for (int i = 0; i < iterations; ++i) {
+            if (setup) setup();
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            result.samplesMs.push_back(elapsed.count());
+        }
+        report(result);
+    }
+
+    // For samples measured elsewhere (e.g. per-stage pipeline timings)
+    void add(const std::string& name, int rows, int cols, std::vector<double> samplesMs) {
+        if (!wants(name) || samplesMs.empty()) return;
+        report({name, rows, cols, std::move(samplesMs)});
+    }
+
+    void setLog(std::ostream* out) { log = out; }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"rows\": " << r.rows << ", \"cols\": " << r.cols
+                << ", \"iterations\": " << r.samplesMs.size()
+                << std::fixed << std::setprecision(4)
+                << ", \"min_ms\": " << r.minMs() << ", \"median_ms\": " << r.medianMs()
+                << ", \"mean_ms\": " << r.meanMs() << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+private:
+    std::string filter;
+    std::vector<BenchResult> results;
+    std::ostream* log = nullptr;
+
+    void report(BenchResult result) {
+        if (log) {
+            *log << std::left << std::setw(40) << result.name << std::right
+                 << std::setw(6) << result.rows << "x" << std::left << std::setw(6) << result.cols << std::right
+                 << std::fixed << std::setprecision(3)
+                 << " min " << std::setw(10) << result.minMs()
+                 << " median " << std::setw(10) << result.medianMs()
+                 << " ms  (" << result.samplesMs.size() << " runs)" << std::endl;
+        }
+        results.push_back(std::move(result));
+    }
+};
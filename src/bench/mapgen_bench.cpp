@@ -0,0 +1,527 @@
+// Headless benchmarks for map generation and the per-map passes around it.
+//
+//   mapgen_bench [--sizes 150x250,1000x1000,4000x4000] [--reps N] [--filter TEXT]
+//                [--json FILE] [--serial]
+//
+// Every MapGenerator stage is timed from inside the pipeline, so each stage is
+// measured on the map the previous stages actually produced.
+//
+// Results go to FILE as JSON, or to stdout without --json; the table printed
+// while the cases run goes to stderr.
+
+#include "BenchHarness.hpp"
+#include "mechanics/MapGenerator.hpp"
+#include "mechanics/Fertility.hpp"
+#include "mechanics/FoW.hpp"
+#include "mechanics/Village.hpp"
+#include "mechanics/Names.hpp"
+#include "mechanics/Noise.hpp"
+#include "mechanics/Erosion.hpp"
+#include "mechanics/TileMask.hpp"
+#include "Tools/Grid.hpp"
+
+#ifdef GRIDGAME_WITH_SFML
+#include "Tools/OverlayTools.hpp"
+#include "Tools/TerrainLod.hpp"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static std::vector<std::pair<int, int>> parseSizes(const std::string& text) {
+    std::vector<std::pair<int, int>> sizes;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t x = item.find('x');
+        if (x == std::string::npos) continue;
+        sizes.push_back({std::stoi(item.substr(0, x)), std::stoi(item.substr(x + 1))});
+    }
+    return sizes;
+}
+
+// Fewer repetitions as maps grow so the full suite stays usable
+static int defaultReps(int rows, int cols) {
+    long long tiles = static_cast<long long>(rows) * cols;
+    if (tiles <= 100000) return 10;
+    if (tiles <= 1000000) return 3;
+    return 1;
+}
+
+// --- Neighbourhood queries, per tile and as mask algebra ---
+// Each pair counts the same tiles on the finished map so the two can be compared
+// directly: "loop" is the scan the generator used to do, "mask" the bitplane version.
+
+static bool isWater(int tile) { return tile == 0 || tile == 7 || tile == 22 || tile == 23; }
+
+// Results that disagreed with their reference; any makes the run exit non-zero
+static int mismatches = 0;
+
+// Tiles matching `matches` with a neighbour matching `near` within `radius` (diagonals included)
+template <typename Matches, typename Near>
+static long long countNearLoop(const std::vector<std::vector<int>>& map, int radius, Matches matches, Near near) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = static_cast<int>(map[0].size());
+    long long total = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (!matches(map[r][c])) continue;
+            bool found = false;
+            for (int dr = -radius; dr <= radius && !found; ++dr) {
+                for (int dc = -radius; dc <= radius && !found; ++dc) {
+                    int nr = r + dr, nc = c + dc;
+                    found = nr >= 0 && nr < rows && nc >= 0 && nc < cols && near(map[nr][nc]);
+                }
+            }
+            total += found;
+        }
+    }
+    return total;
+}
+
+static long long countSurroundedLoop(const std::vector<std::vector<int>>& map) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = static_cast<int>(map[0].size());
+    long long total = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            bool surrounded = true;
+            for (int dr = -1; dr <= 1; ++dr) {
+                for (int dc = -1; dc <= 1; ++dc) {
+                    int nr = r + dr, nc = c + dc;
+                    if ((dr || dc) && nr >= 0 && nr < rows && nc >= 0 && nc < cols) {
+                        surrounded &= map[nr][nc] == 3 || map[nr][nc] == 7;
+                    }
+                }
+            }
+            total += surrounded;
+        }
+    }
+    return total;
+}
+
+static long long countPolarLoop(const std::vector<std::vector<int>>& map) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = static_cast<int>(map[0].size());
+    // Integer limits, as the old convertToTaiga had them
+    const int topLimit = rows / 6.5;
+    const int bottomLimit = 5 * rows / 6;
+    long long total = 0;
+    for (int r = 0; r < rows; ++r) {
+        if (r >= topLimit && r < bottomLimit) continue;
+        for (int c = 0; c < cols; ++c) total += map[r][c] == 10 || map[r][c] == 11;
+    }
+    return total;
+}
+
+static void benchMasks(BenchHarness& bench, const std::vector<std::vector<int>>& map, int iterations) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = static_cast<int>(map[0].size());
+    // -1 until the case runs, so a pair half excluded by --filter is not compared
+    long long loopCount = -1, maskCount = -1;
+    auto check = [&](const char* name) {
+        if (loopCount >= 0 && maskCount >= 0 && loopCount != maskCount) {
+            std::cerr << "masks/" << name << ": loop " << loopCount << " != mask " << maskCount << "\n";
+            ++mismatches;
+        }
+        loopCount = maskCount = -1;
+    };
+
+    // Floodplain next to a river
+    bench.run("masks/floodplain_loop", rows, cols, iterations, [&]() {
+        loopCount = countNearLoop(map, 1, [](int t) { return t == 17; }, [](int t) { return t == 6; });
+    });
+    bench.run("masks/floodplain_mask", rows, cols, iterations, [&]() {
+        TileMask rivers = TileMask::fromMap(map, [](int t) { return t == 6; });
+        TileMask plains = TileMask::fromMap(map, [](int t) { return t == 17; });
+        maskCount = (plains & rivers.dilate()).count();
+    });
+    check("floodplain");
+
+    // Coast within two tiles of land
+    bench.run("masks/coast_loop", rows, cols, iterations, [&]() {
+        loopCount = countNearLoop(map, 2, [](int t) { return t == 22; }, [](int t) { return !isWater(t); });
+    });
+    bench.run("masks/coast_mask", rows, cols, iterations, [&]() {
+        TileMask water = TileMask::fromMap(map, isWater);
+        TileMask coast = TileMask::fromMap(map, [](int t) { return t == 22; });
+        maskCount = (coast & (~water).dilate().dilate()).count();
+    });
+    check("coast");
+
+    // Tiles ringed by mountains and ice
+    bench.run("masks/surrounded_loop", rows, cols, iterations, [&]() { loopCount = countSurroundedLoop(map); });
+    bench.run("masks/surrounded_mask", rows, cols, iterations, [&]() {
+        TileMask peaks = TileMask::fromMap(map, [](int t) { return t == 3 || t == 7; });
+        maskCount = peaks.allNeighbours().count();
+    });
+    check("surrounded");
+
+    // Taiga in the polar bands
+    bench.run("masks/taiga_loop", rows, cols, iterations, [&]() { loopCount = countPolarLoop(map); });
+    bench.run("masks/taiga_mask", rows, cols, iterations, [&]() {
+        TileMask polar = TileMask::rowBand(rows, cols, 0, static_cast<int>(rows / 6.5)) |
+                         TileMask::rowBand(rows, cols, 5 * rows / 6, rows);
+        maskCount = (polar & TileMask::fromMap(map, [](int t) { return t == 10 || t == 11; })).count();
+    });
+    check("taiga");
+
+    // The word-parallel part on its own, without building the mask from the map
+    TileMask land = ~TileMask::fromMap(map, isWater);
+    bench.run("masks/dilate8", rows, cols, iterations * 10, [&]() { maskCount = land.dilate().count(); });
+}
+
+// --- Grid layouts ---
+// The stencils of the existing passes written once against Grid's calls and run
+// on each layout. "nested" is the std::vector<std::vector<>> the passes use now.
+
+// Grid's calls over nested vectors
+template <typename T>
+class NestedGrid {
+public:
+    static NestedGrid fromRows(const std::vector<std::vector<T>>& source) { return NestedGrid(source); }
+    void toRows(std::vector<std::vector<T>>& target) const { target = cells; }
+
+    const T& at(int row, int col) const { return cells[row][col]; }
+    void fill(const T& value) {
+        for (auto& row : cells) std::fill(row.begin(), row.end(), value);
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (int r = 0; r < static_cast<int>(cells.size()); ++r) {
+            for (int c = 0; c < static_cast<int>(cells[r].size()); ++c) fn(r, c, cells[r][c]);
+        }
+    }
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (int r = 0; r < static_cast<int>(cells.size()); ++r) {
+            for (int c = 0; c < static_cast<int>(cells[r].size()); ++c) fn(r, c, cells[r][c]);
+        }
+    }
+    template <typename Fn>
+    void forEachNear(int row, int col, int radius, Fn&& fn) {
+        const int top = std::max(0, row - radius), bottom = std::min(static_cast<int>(cells.size()) - 1, row + radius);
+        const int left = std::max(0, col - radius), right = std::min(static_cast<int>(cells[0].size()) - 1, col + radius);
+        for (int r = top; r <= bottom; ++r) {
+            for (int c = left; c <= right; ++c) fn(r, c, cells[r][c]);
+        }
+    }
+    template <typename Fn>
+    void forEachNear(int row, int col, int radius, Fn&& fn) const {
+        const_cast<NestedGrid*>(this)->forEachNear(row, col, radius, [&](int r, int c, const T& value) { fn(r, c, value); });
+    }
+
+private:
+    explicit NestedGrid(const std::vector<std::vector<T>>& source) : cells(source) {}
+    std::vector<std::vector<T>> cells;
+};
+
+// FertilityMap's 3x3 box blur
+template <typename FloatGrid>
+static void blur3(const FloatGrid& source, FloatGrid& target) {
+    target.forEach([&](int r, int c, float& out) {
+        float sum = 0.0f;
+        int count = 0;
+        source.forEachNear(r, c, 1, [&](int, int, float value) {
+            sum += value;
+            ++count;
+        });
+        out = sum / count;
+    });
+}
+
+// smoothMap's kind of vote: a tile with five or more water neighbours turns to sea
+template <typename IntGrid>
+static void majority3(const IntGrid& source, IntGrid& target) {
+    target.forEach([&](int r, int c, int& out) {
+        int water = 0;
+        source.forEachNear(r, c, 1, [&](int nr, int nc, int tile) { water += (nr != r || nc != c) && isWater(tile); });
+        out = water >= 5 ? 0 : source.at(r, c);
+    });
+}
+
+// applyCoastChance's 5x5 question: coast with land within two tiles
+template <typename IntGrid>
+static long long coast5(const IntGrid& map) {
+    long long total = 0;
+    map.forEach([&](int r, int c, int tile) {
+        if (tile != 22) return;
+        bool found = false;
+        map.forEachNear(r, c, 2, [&](int, int, int near) { found |= !isWater(near); });
+        total += found;
+    });
+    return total;
+}
+
+// FogOfWarMap::revealRadius at radius 8
+template <typename IntGrid>
+static void reveal8(IntGrid& fog, const std::vector<std::pair<int, int>>& centres) {
+    for (auto [row, col] : centres) {
+        fog.forEachNear(row, col, 8, [&](int r, int c, int& cell) {
+            if ((r - row) * (r - row) + (c - col) * (c - col) <= 64) cell = 2;
+        });
+    }
+}
+
+// Outputs from the nested run, which every layout must reproduce
+struct LayoutResults {
+    std::vector<std::vector<float>> blurred;
+    std::vector<std::vector<int>> voted;
+    std::vector<std::vector<int>> revealed;
+    long long coast = -1;
+};
+
+template <typename IntGrid, typename FloatGrid>
+static void benchLayout(BenchHarness& bench, const std::string& layout, const std::vector<std::vector<int>>& map,
+                        const std::vector<std::vector<float>>& fertility,
+                        const std::vector<std::pair<int, int>>& centres, int iterations, LayoutResults& expected) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = static_cast<int>(map[0].size());
+    // Only cases --filter let run are compared; the first to run sets the expected result
+    auto ran = [&](const char* name) { return bench.wants("layout/" + std::string(name) + "_" + layout); };
+    auto check = [&](const char* name, bool same) {
+        if (same) return;
+        std::cerr << "layout/" << name << "_" << layout << ": differs from nested\n";
+        ++mismatches;
+    };
+
+    const FloatGrid fertilityGrid = FloatGrid::fromRows(fertility);
+    FloatGrid blurred = fertilityGrid;
+    bench.run("layout/blur3_" + layout, rows, cols, iterations, [&]() { blur3(fertilityGrid, blurred); });
+    if (ran("blur3")) {
+        std::vector<std::vector<float>> blurredRows;
+        blurred.toRows(blurredRows);
+        if (expected.blurred.empty()) expected.blurred = blurredRows;
+        check("blur3", blurredRows == expected.blurred);
+    }
+
+    const IntGrid tiles = IntGrid::fromRows(map);
+    IntGrid voted = tiles;
+    bench.run("layout/majority3_" + layout, rows, cols, iterations, [&]() { majority3(tiles, voted); });
+    if (ran("majority3")) {
+        std::vector<std::vector<int>> votedRows;
+        voted.toRows(votedRows);
+        if (expected.voted.empty()) expected.voted = votedRows;
+        check("majority3", votedRows == expected.voted);
+    }
+
+    long long coast = 0;
+    bench.run("layout/coast5_" + layout, rows, cols, iterations, [&]() { coast = coast5(tiles); });
+    if (ran("coast5")) {
+        if (expected.coast < 0) expected.coast = coast;
+        check("coast5", coast == expected.coast);
+    }
+
+    IntGrid fog = tiles;
+    bench.run("layout/reveal8_x1000_" + layout, rows, cols, iterations, [&]() { reveal8(fog, centres); },
+              [&]() { fog.fill(0); });
+    if (ran("reveal8_x1000")) {
+        std::vector<std::vector<int>> revealedRows;
+        fog.toRows(revealedRows);
+        if (expected.revealed.empty()) expected.revealed = revealedRows;
+        check("reveal8", revealedRows == expected.revealed);
+    }
+}
+
+static void benchLayouts(BenchHarness& bench, const std::vector<std::vector<int>>& map,
+                         const std::vector<std::vector<float>>& fertility,
+                         const std::vector<std::pair<int, int>>& centres, int iterations) {
+    LayoutResults expected;
+    benchLayout<NestedGrid<int>, NestedGrid<float>>(bench, "nested", map, fertility, centres, iterations, expected);
+    benchLayout<Grid<int>, Grid<float>>(bench, RowMajorLayout::name(), map, fertility, centres, iterations, expected);
+    benchLayout<Grid<int, TiledLayout<3>>, Grid<float, TiledLayout<3>>>(bench, TiledLayout<3>::name(), map, fertility,
+                                                                        centres, iterations, expected);
+    benchLayout<Grid<int, TiledLayout<4>>, Grid<float, TiledLayout<4>>>(bench, TiledLayout<4>::name(), map, fertility,
+                                                                        centres, iterations, expected);
+    benchLayout<Grid<int, MortonLayout>, Grid<float, MortonLayout>>(bench, MortonLayout::name(), map, fertility,
+                                                                    centres, iterations, expected);
+}
+
+int main(int argc, char** argv) {
+    std::string sizesText = "150x250,1000x1000,4000x4000";
+    std::string filter;
+    std::string jsonPath;
+    int reps = 0;
+    bool serial = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--sizes") sizesText = next();
+        else if (arg == "--reps") reps = std::stoi(next());
+        else if (arg == "--filter") filter = next();
+        else if (arg == "--json") jsonPath = next();
+        else if (arg == "--serial") serial = true;
+        else {
+            std::cerr << "usage: mapgen_bench [--sizes RxC,...] [--reps N] [--filter TEXT] [--json FILE] [--serial]\n";
+            return 2;
+        }
+    }
+
+    BenchHarness bench(filter);
+    // The table goes to stderr so stdout carries nothing but the JSON
+    bench.setLog(&std::cerr);
+
+    // --- Names (no map involved, so no size) ---
+    bench.run("names/generateBulk_10000", 0, 0, reps > 0 ? reps : 10, [&]() {
+        NameService names(7u);
+        std::vector<NameId> ids;
+        names.generateBulk(10000, ids);
+    });
+
+    for (auto [rows, cols] : parseSizes(sizesText)) {
+        const int iterations = reps > 0 ? reps : defaultReps(rows, cols);
+
+        // --- Generation stages ---
+        std::map<std::string, std::vector<double>> stageSamples;
+        std::vector<double> totalSamples;
+        std::vector<std::vector<int>> lastMap;
+
+        for (int rep = 0; rep < iterations; ++rep) {
+            MapGenerator mapGenerator(rows, cols, 1000u + rep);
+            mapGenerator.getPipeline().setParallel(!serial);
+            mapGenerator.generateMap();
+
+            double total = 0.0;
+            for (const StageTiming& timing : mapGenerator.getPipeline().getTimings()) {
+                stageSamples[timing.name].push_back(timing.millis);
+                total += timing.millis;
+            }
+            totalSamples.push_back(total);
+            if (rep + 1 == iterations) lastMap = mapGenerator.getMap();
+        }
+        for (auto& [name, samples] : stageSamples) {
+            bench.add("stage/" + name, rows, cols, samples);
+        }
+        bench.add("generateMap", rows, cols, totalSamples);
+
+        // --- Coarse-to-fine layout (resources/pipeline_coarse.cfg) at both scales ---
+        for (int scale : {4, 8}) {
+            const std::string name = "generateMap_coarse" + std::to_string(scale);
+            if (!bench.wants(name)) continue;
+            std::vector<double> coarseSamples;
+            for (int rep = 0; rep < iterations; ++rep) {
+                MapGenerator mapGenerator(rows, cols, 1000u + rep);
+                std::vector<std::string> order = {"coarseLayout"};
+                for (const std::string& name : mapGenerator.getPipeline().getOrder()) {
+                    if (name != "initializeMap" && name != "fillUnassignedWithSea" && name != "blendMap" &&
+                        name != "smoothMap") {
+                        order.push_back(name);
+                    }
+                }
+                mapGenerator.getPipeline().setOrder(order);
+                mapGenerator.setLayoutScale(scale);
+                mapGenerator.getPipeline().setParallel(!serial);
+                mapGenerator.generateMap();
+
+                double total = 0.0;
+                for (const StageTiming& timing : mapGenerator.getPipeline().getTimings()) total += timing.millis;
+                coarseSamples.push_back(total);
+            }
+            bench.add(name, rows, cols, coarseSamples);
+        }
+
+        // --- Noise heightfield (the continuous terrain mode's first stage) ---
+        bench.run("noise/heightfield_1thread", rows, cols, iterations,
+                  [&]() { std::vector<float> field = generateHeightfield(rows, cols, 7u, {}, 1); });
+        if (!serial) {
+            bench.run("noise/heightfield", rows, cols, iterations,
+                      [&]() { std::vector<float> field = generateHeightfield(rows, cols, 7u, {}, 0); });
+        }
+
+        // --- Droplet erosion of the same field (the optional erodeHeightMap stage's kernel) ---
+        std::vector<float> heightfield, eroded;
+        auto resetField = [&]() {
+            if (heightfield.empty()) heightfield = generateHeightfield(rows, cols, 7u, {}, 0);
+            eroded = heightfield;
+        };
+        bench.run("erosion/droplets_1thread", rows, cols, iterations,
+                  [&]() { erodeHeightfield(eroded, rows, cols, {}, 7u, {}, 1); },
+                  resetField);
+        if (!serial) {
+            bench.run("erosion/droplets", rows, cols, iterations,
+                      [&]() { erodeHeightfield(eroded, rows, cols, {}, 7u, {}, 0); },
+                      resetField);
+        }
+
+        // --- Fertility ---
+        FertilityMap fertility(rows, cols);
+        bench.run("fertility/generateFromTerrain", rows, cols, iterations,
+                  [&]() { fertility.generateFromTerrain(lastMap, 7u); });
+
+        // --- Fog of war ---
+        FogOfWarMap fog(rows, cols);
+        std::mt19937 rng(11u);
+        std::vector<std::pair<int, int>> centres;
+        for (int i = 0; i < 1000; ++i) {
+            centres.push_back({static_cast<int>(rng() % rows), static_cast<int>(rng() % cols)});
+        }
+        bench.run("fog/revealRadius8_x1000", rows, cols, iterations,
+                  [&]() { for (auto [r, c] : centres) fog.revealRadius(r, c, 8); },
+                  [&]() { fog.resetFog(); });
+        bench.run("fog/markSeen", rows, cols, iterations, [&]() { fog.markSeen(); });
+
+        // --- Villages: one on every fertile tile of a sparse lattice, run for a few turns first ---
+        if (bench.wants("villages/updateTurn")) {
+            FertilityMap villageFertility(rows, cols);
+            villageFertility.generateFromTerrain(lastMap, 7u);
+            VillageSystem villages(rows, cols, villageFertility.getFertilityGrid());
+            for (int r = 0; r < rows; r += 7) {
+                for (int c = 0; c < cols; c += 7) villages.found(r, c, 0);
+            }
+            for (int turn = 0; turn < 10; ++turn) villages.updateTurn(serial ? 1 : 0);
+            std::cerr << "villages: " << villages.getLiving() << " on " << rows << "x" << cols << "\n";
+            bench.run("villages/updateTurn", rows, cols, iterations * 10,
+                      [&]() { villages.updateTurn(serial ? 1 : 0); });
+        }
+
+        benchMasks(bench, lastMap, iterations);
+        benchLayouts(bench, lastMap, fertility.getFertilityGrid(), centres, iterations);
+
+#ifdef GRIDGAME_WITH_SFML
+        // --- Overlays ---
+        const float cellSize = 8.0f;
+        bench.run("overlay/terrain", rows, cols, iterations,
+                  [&]() { sf::VertexArray v = createTerrainGrid(lastMap, cellSize, 7u); });
+        // CPU side of the LOD chain (level images); the upload needs a window
+        bench.run("overlay/terrainLod", rows, cols, iterations,
+                  [&]() { TerrainLod lod; lod.build(lastMap, cellSize, 7u); });
+        bench.run("overlay/fertility", rows, cols, iterations,
+                  [&]() { sf::VertexArray v = createFertilityOverlay(fertility, cellSize); });
+        bench.run("overlay/fog", rows, cols, iterations,
+                  [&]() { sf::VertexArray v = createFogOverlay(fog, cellSize); });
+#endif
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "cannot write " << jsonPath << "\n";
+            return 1;
+        }
+        bench.writeJson(out);
+    } else {
+        bench.writeJson(std::cout);
+    }
+    if (mismatches > 0) {
+        std::cerr << mismatches << " result(s) differ from their reference\n";
+        return 1;
+    }
+    return 0;
+}
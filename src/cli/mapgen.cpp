@@ -0,0 +1,229 @@
+// Headless map generator: no window, no font, no SFML.
+//
+//   mapgen [--rows N] [--cols N] [--seed S] [--stages FILE] [--serial]
+//          [--erosion DROPLETS] [--layout-scale N] [--timings] [--out FILE] [--trace FILE]
+//   mapgen --golden-check FILE | --golden-write FILE [--stages FILE] [--serial]
+//
+// The golden modes generate a fixed set of (seed, size) maps and compare them
+// against stored hashes and summary statistics (see MapStats.hpp). Run
+// --golden-check before accepting a generator rewrite; only rewrite the file
+// with --golden-write when a change to the output is intended.
+
+#include "mechanics/MapGenerator.hpp"
+#include "mechanics/Fertility.hpp"
+#include "mechanics/MapStats.hpp"
+#include "Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static void printUsage() {
+    std::cout << "usage: mapgen [--rows N] [--cols N] [--seed S] [--stages FILE] [--serial]\n"
+                 "              [--erosion DROPLETS] [--layout-scale N] [--timings] [--out FILE] [--trace FILE]\n"
+                 "       mapgen --golden-check FILE | --golden-write FILE [--stages FILE] [--serial]\n"
+                 "  --stages FILE  stage order file (see resources/pipeline.cfg;\n"
+                 "                 resources/pipeline_noise.cfg uses the noise terrain,\n"
+                 "                 resources/pipeline_coarse.cfg lays biomes out at low resolution)\n"
+                 "  --serial       run every stage on one thread\n"
+                 "  --erosion DROPLETS  erode the height map with this many droplets before\n"
+                 "                 flowRivers (adds the erodeHeightMap stage; 0 = one per two tiles)\n"
+                 "  --layout-scale N  resolution divisor for coarseLayout: 1, 2, 4 (default) or 8\n"
+                 "  --timings      print per-stage wall time (and allocations with GRIDGAME_COUNT_ALLOCATIONS)\n"
+                 "  --out FILE     write the tile grid as whitespace separated rows\n"
+                 "  --trace FILE   write a Chrome trace of the generation stages\n"
+                 "  --golden-check FILE  compare the reference maps against FILE\n"
+                 "  --golden-write FILE  regenerate FILE from the current generator\n";
+}
+
+// Reference maps: a few seeds at the game's size plus odd shapes that catch
+// edge and indexing mistakes
+static const std::vector<std::vector<int>> goldenCases = {
+    {1, 150, 250},
+    {42, 150, 250},
+    {1337, 150, 250},
+    {7, 64, 64},
+    {99, 37, 211},
+    {2024, 300, 500},
+};
+
+// stages is an order main has already checked, so setOrder cannot fail here
+static MapStats generateStats(unsigned int seed, int rows, int cols, const std::vector<std::string>& stages,
+                              bool serial) {
+    MapGenerator mapGenerator(rows, cols, seed);
+    mapGenerator.getPipeline().setOrder(stages);
+    mapGenerator.getPipeline().setParallel(!serial);
+    mapGenerator.generateMap();
+    return computeMapStats(mapGenerator.getMap());
+}
+
+static int writeGoldens(const std::string& path, const std::vector<std::string>& stages, bool serial) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "cannot write " << path << "\n";
+        return 1;
+    }
+    out << "# Golden maps for mapgen --golden-check, written by mapgen --golden-write.\n"
+           "# seed rows cols hash river lakes coastline tile:count ...\n"
+           "# Values depend on the standard library's <random> distributions (libstdc++).\n";
+    for (const auto& c : goldenCases) {
+        GoldenMap golden{static_cast<unsigned int>(c[0]), c[1], c[2], {}};
+        golden.stats = generateStats(golden.seed, golden.rows, golden.cols, stages, serial);
+        writeGoldenLine(out, golden);
+        std::cout << "seed " << golden.seed << " " << golden.rows << "x" << golden.cols << " written\n";
+    }
+    return 0;
+}
+
+static int checkGoldens(const std::string& path, const std::vector<std::string>& stages, bool serial) {
+    std::vector<GoldenMap> goldens = readGoldenFile(path);
+    if (goldens.empty()) {
+        std::cerr << "no golden maps in " << path << "\n";
+        return 1;
+    }
+
+    int different = 0;
+    for (const GoldenMap& golden : goldens) {
+        MapStats actual = generateStats(golden.seed, golden.rows, golden.cols, stages, serial);
+        std::string why;
+        GoldenResult result = compareToGolden(golden.stats, actual, why);
+
+        std::cout << "seed " << golden.seed << " " << golden.rows << "x" << golden.cols << ": ";
+        if (result == GoldenResult::Identical) {
+            std::cout << "identical\n";
+        } else if (result == GoldenResult::Equivalent) {
+            std::cout << "equivalent (hash differs, statistics within tolerance)\n";
+        } else {
+            std::cout << "DIFFERENT" << why << "\n";
+            ++different;
+        }
+    }
+    std::cout << goldens.size() - different << "/" << goldens.size() << " golden maps match\n";
+    return different == 0 ? 0 : 1;
+}
+
+// Puts erodeHeightMap in front of flowRivers unless the stage order already has it
+static bool addErosion(MapGenerator& mapGenerator, int droplets) {
+    ErosionSettings settings;
+    settings.droplets = droplets;
+    mapGenerator.setErosionSettings(settings);
+
+    std::vector<std::string> order = mapGenerator.getPipeline().getOrder();
+    if (std::find(order.begin(), order.end(), "erodeHeightMap") != order.end()) return true;
+    auto rivers = std::find(order.begin(), order.end(), "flowRivers");
+    if (rivers == order.end()) {
+        std::cerr << "--erosion needs flowRivers in the stage order\n";
+        return false;
+    }
+    order.insert(rivers, "erodeHeightMap");
+    return mapGenerator.getPipeline().setOrder(order);
+}
+
+int main(int argc, char** argv) {
+    int rows = 150;
+    int cols = 250;
+    unsigned int seed = std::random_device{}();
+    std::string stagesPath;
+    std::string outPath;
+    std::string tracePath;
+    bool serial = false;
+    bool timings = false;
+    int erosionDroplets = -1;
+    int layoutScale = 0;
+    std::string goldenCheckPath;
+    std::string goldenWritePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--rows") rows = std::stoi(next());
+        else if (arg == "--cols") cols = std::stoi(next());
+        else if (arg == "--seed") seed = static_cast<unsigned int>(std::stoul(next()));
+        else if (arg == "--stages") stagesPath = next();
+        else if (arg == "--out") outPath = next();
+        else if (arg == "--trace") tracePath = next();
+        else if (arg == "--golden-check") goldenCheckPath = next();
+        else if (arg == "--golden-write") goldenWritePath = next();
+        else if (arg == "--serial") serial = true;
+        else if (arg == "--erosion") erosionDroplets = std::stoi(next());
+        else if (arg == "--layout-scale") layoutScale = std::stoi(next());
+        else if (arg == "--timings") timings = true;
+        else if (arg == "--help" || arg == "-h") { printUsage(); return 0; }
+        else {
+            std::cerr << "unknown argument " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+
+    // A bad stage config is a usage error in every mode, not a silent fall back to the defaults
+    MapGenerator mapGenerator(rows, cols, seed);
+    if (!stagesPath.empty() && !mapGenerator.loadStageConfig(stagesPath)) {
+        return 2;
+    }
+    const std::vector<std::string> stages = mapGenerator.getPipeline().getOrder();
+    if (!goldenWritePath.empty()) return writeGoldens(goldenWritePath, stages, serial);
+    if (!goldenCheckPath.empty()) return checkGoldens(goldenCheckPath, stages, serial);
+
+    mapGenerator.getPipeline().setParallel(!serial);
+    if (layoutScale > 0) mapGenerator.setLayoutScale(layoutScale);
+    if (erosionDroplets >= 0 && !addErosion(mapGenerator, erosionDroplets)) {
+        return 1;
+    }
+
+    Profiler::setEnabled(!tracePath.empty());
+    Profiler::setThreadName("mapgen");
+
+    auto start = std::chrono::steady_clock::now();
+    mapGenerator.generateMap();
+    FertilityMap fertility(rows, cols);
+    fertility.generateFromTerrain(mapGenerator.getMap(), seed);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "seed " << seed << ", " << rows << "x" << cols << ", " << elapsed.count() << " ms\n";
+
+    std::map<int, long long> histogram;
+    for (const auto& row : mapGenerator.getMap()) {
+        for (int tile : row) ++histogram[tile];
+    }
+    for (const auto& [tile, count] : histogram) {
+        std::cout << "  tile " << tile << ": " << count << "\n";
+    }
+
+    if (timings) {
+        mapGenerator.getPipeline().printTimings(std::cout);
+    }
+
+    if (!tracePath.empty() && !Profiler::writeChromeTrace(tracePath)) {
+        std::cerr << "cannot write " << tracePath << "\n";
+        return 1;
+    }
+
+    if (!outPath.empty()) {
+        std::ofstream out(outPath);
+        if (!out) {
+            std::cerr << "cannot write " << outPath << "\n";
+            return 1;
+        }
+        for (const auto& row : mapGenerator.getMap()) {
+            for (size_t c = 0; c < row.size(); ++c) {
+                out << row[c] << (c + 1 < row.size() ? ' ' : '\n');
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+// Batch seed search: generate many maps, keep the ones that meet the criteria
+// and print the best seeds. No window, no SFML.
+//
+//   seedsearch [--rows N] [--cols N] [--seed S] [--count K] [--threads T] [--top N]
+//              [--stages FILE] [--layout-scale N]
+//              [--land MIN:MAX] [--continents MIN:MAX] [--rivers MIN:MAX] [--fairness MIN:MAX]
+//              [--prefer METRIC=TARGET[:WEIGHT]]...
+//
+// Seeds S..S+K-1 are shared out to one worker per thread. Each worker owns its
+// generator and fertility map and reuses them from seed to seed, so workers
+// share nothing but the seed counter. A map is dropped as soon as a metric
+// with a range is final (see finalAfter in MapScore.hpp) and out of range;
+// the remaining stages are cancelled.
+
+#include "mechanics/MapGenerator.hpp"
+#include "mechanics/Fertility.hpp"
+#include "mechanics/MapScore.hpp"
+#include "Tools/ParallelFor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SearchOptions {
+    int rows = 150;
+    int cols = 250;
+    unsigned int seed = 1;
+    long long count = 1000;
+    int threads = 0;
+    int top = 10;
+    std::string stagesPath;
+    std::vector<std::string> stages; // the order stagesPath lists, checked once in main
+    int layoutScale = 0;
+    MapCriteria criteria;
+};
+
+struct Candidate {
+    unsigned int seed;
+    double score;
+    double values[MapMetricCount];
+};
+
+// What one worker saw
+struct WorkerResult {
+    std::vector<Candidate> best; // highest score first, at most options.top
+    long long generated = 0;
+    long long cancelled = 0;     // dropped part way through generation
+    long long rejected = 0;      // dropped once finished (fairness, or a metric no stage settles)
+};
+
+static void printUsage() {
+    std::cout << "usage: seedsearch [--rows N] [--cols N] [--seed S] [--count K] [--threads T] [--top N]\n"
+                 "                  [--stages FILE] [--layout-scale N]\n"
+                 "                  [--land MIN:MAX] [--continents MIN:MAX] [--rivers MIN:MAX] [--fairness MIN:MAX]\n"
+                 "                  [--prefer METRIC=TARGET[:WEIGHT]]...\n"
+                 "  --count K        search seeds S..S+K-1\n"
+                 "  --threads T      workers (0 = one per core)\n"
+                 "  --top N          how many of the best seeds to print\n"
+                 "  --land ...       ranges a map must meet; either end may be left out (0.3: or :0.5)\n"
+                 "                   land is a fraction, continents and rivers are counts,\n"
+                 "                   fairness runs from 0 to 1 (alike starting spots)\n"
+                 "  --prefer ...     rank maps by closeness to targets (repeatable);\n"
+                 "                   without it the fairest maps come first\n";
+}
+
+static bool parseRange(const std::string& text, MapCriteria::Range& range) {
+    const size_t colon = text.find(':');
+    if (colon == std::string::npos) return false;
+    try {
+        const std::string low = text.substr(0, colon), high = text.substr(colon + 1);
+        range.min = low.empty() ? -1e300 : std::stod(low);
+        range.max = high.empty() ? 1e300 : std::stod(high);
+    } catch (const std::exception&) {
+        return false;
+    }
+    range.active = true;
+    return range.min <= range.max;
+}
+
+static bool parseTarget(const std::string& text, MapCriteria::Target& target) {
+    const size_t equals = text.find('=');
+    if (equals == std::string::npos || !parseMetric(text.substr(0, equals), target.metric)) return false;
+    const std::string value = text.substr(equals + 1);
+    const size_t colon = value.find(':');
+    try {
+        target.value = std::stod(value.substr(0, colon));
+        target.weight = colon == std::string::npos ? 1.0 : std::stod(value.substr(colon + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+static void keepBest(std::vector<Candidate>& best, const Candidate& candidate, int top) {
+    auto better = [](const Candidate& a, const Candidate& b) {
+        return a.score != b.score ? a.score > b.score : a.seed < b.seed;
+    };
+    best.insert(std::upper_bound(best.begin(), best.end(), candidate, better), candidate);
+    if (static_cast<int>(best.size()) > top) best.pop_back();
+}
+
+static WorkerResult runWorker(const SearchOptions& options, std::atomic<long long>& next) {
+    WorkerResult result;
+    MapGenerator generator(options.rows, options.cols, options.seed);
+    generator.getPipeline().setOrder(options.stages);
+    if (options.layoutScale > 0) generator.setLayoutScale(options.layoutScale);
+    generator.getPipeline().setParallel(false); // the other workers already fill the cores
+    FertilityMap fertility(options.rows, options.cols);
+    const MapCriteria& criteria = options.criteria;
+
+    for (long long i = next++; i < options.count; i = next++) {
+        const unsigned int seed = options.seed + static_cast<unsigned int>(i);
+        Candidate candidate{seed, 0.0, {}};
+        bool measured[MapMetricCount] = {};
+        ++result.generated;
+
+        generator.setSeed(seed);
+        const bool finished = generator.generateMap([&](const GenerationProgress& progress) {
+            for (int m = 0; m < MapMetricCount; ++m) {
+                const MapMetric metric = static_cast<MapMetric>(m);
+                if (!criteria.ranges[m].active || std::string(finalAfter(metric)) != progress.stageName) continue;
+                candidate.values[m] = measureMetric(metric, generator.getMap(), fertility.getFertilityGrid());
+                measured[m] = true;
+                if (!criteria.accepts(metric, candidate.values[m])) return false;
+            }
+            return true;
+        });
+        if (!finished) {
+            ++result.cancelled;
+            continue;
+        }
+
+        fertility.generateFromTerrain(generator.getMap(), seed);
+        bool accepted = true;
+        for (int m = 0; m < MapMetricCount && accepted; ++m) {
+            if (!measured[m]) {
+                candidate.values[m] = measureMetric(static_cast<MapMetric>(m), generator.getMap(), fertility.getFertilityGrid());
+            }
+            accepted = criteria.accepts(static_cast<MapMetric>(m), candidate.values[m]);
+        }
+        if (!accepted) {
+            ++result.rejected;
+            continue;
+        }
+
+        candidate.score = criteria.score(candidate.values);
+        keepBest(result.best, candidate, options.top);
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    SearchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        MapMetric metric;
+        if (arg == "--rows") options.rows = std::stoi(next());
+        else if (arg == "--cols") options.cols = std::stoi(next());
+        else if (arg == "--seed") options.seed = static_cast<unsigned int>(std::stoul(next()));
+        else if (arg == "--count") options.count = std::stoll(next());
+        else if (arg == "--threads") options.threads = std::stoi(next());
+        else if (arg == "--top") options.top = std::stoi(next());
+        else if (arg == "--stages") options.stagesPath = next();
+        else if (arg == "--layout-scale") options.layoutScale = std::stoi(next());
+        else if (arg.rfind("--", 0) == 0 && parseMetric(arg.substr(2), metric)) {
+            const std::string text = next();
+            if (!parseRange(text, options.criteria.ranges[static_cast<int>(metric)])) {
+                std::cerr << "bad range " << text << " for " << arg << " (expected MIN:MAX)\n";
+                return 2;
+            }
+        } else if (arg == "--prefer") {
+            const std::string text = next();
+            MapCriteria::Target target;
+            if (!parseTarget(text, target)) {
+                std::cerr << "bad target " << text << " (expected METRIC=TARGET[:WEIGHT])\n";
+                return 2;
+            }
+            options.criteria.targets.push_back(target);
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else {
+            std::cerr << "unknown argument " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+    if (options.count < 1 || options.rows < 1 || options.cols < 1 || options.top < 1) {
+        std::cerr << "--count, --rows, --cols and --top must be positive\n";
+        return 2;
+    }
+    MapGenerator probe(1, 1, options.seed);
+    if (!options.stagesPath.empty() && !probe.loadStageConfig(options.stagesPath)) return 2;
+    options.stages = probe.getPipeline().getOrder();
+
+    int workers = options.threads > 0 ? options.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    workers = static_cast<int>(std::min<long long>(workers, options.count));
+
+    std::atomic<long long> nextSeed{0};
+    std::vector<WorkerResult> results(workers);
+    auto start = std::chrono::steady_clock::now();
+    parallelFor(workers, workers, [&](int worker) { results[worker] = runWorker(options, nextSeed); });
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WorkerResult total;
+    for (const WorkerResult& result : results) {
+        total.generated += result.generated;
+        total.cancelled += result.cancelled;
+        total.rejected += result.rejected;
+        for (const Candidate& candidate : result.best) keepBest(total.best, candidate, options.top);
+    }
+    const long long accepted = total.generated - total.cancelled - total.rejected;
+
+    std::cout << total.generated << " seeds (" << options.rows << "x" << options.cols << ") in " << std::fixed
+              << std::setprecision(2) << wallSeconds << " s on " << workers << " threads, " << std::setprecision(1)
+              << total.generated / wallSeconds << " maps/s\n"
+              << "  cancelled during generation " << total.cancelled << ", rejected when finished "
+              << total.rejected << ", accepted " << accepted << "\n";
+    if (total.best.empty()) return 1;
+
+    std::cout << "\n" << std::setw(4) << "rank" << std::setw(12) << "seed" << std::setw(10) << "score";
+    for (int m = 0; m < MapMetricCount; ++m) std::cout << std::setw(12) << metricName(static_cast<MapMetric>(m));
+    std::cout << "\n";
+    for (size_t rank = 0; rank < total.best.size(); ++rank) {
+        const Candidate& candidate = total.best[rank];
+        std::cout << std::setw(4) << rank + 1 << std::setw(12) << candidate.seed << std::setw(10)
+                  << std::setprecision(3) << candidate.score << std::setw(12) << candidate.values[0]
+                  << std::setw(12) << std::setprecision(0) << candidate.values[1] << std::setw(12)
+                  << candidate.values[2] << std::setw(12) << std::setprecision(3) << candidate.values[3] << "\n";
+    }
+    return 0;
+}
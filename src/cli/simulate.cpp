@@ -0,0 +1,289 @@
+// Headless simulation for AI-only soak runs: no window, no SFML.
+//
+//   simulate [--rows N] [--cols N] [--seed S] [--worlds K] [--threads T]
+//            [--turns N] [--tribes N] [--report N] [--until-explored F]
+//            [--max-seconds S] [--stages FILE]
+//
+// Each world (seeds S, S+1, ...) is generated, given fertility, and run
+// tick by tick as fast as possible with every tribe, the player's included,
+// controlled by the AI. Worlds run in parallel, one per thread. Invariants are
+// checked at every report, every 256 turns and on the last turn; the exit code
+// is non-zero if any world broke one.
+
+#include "mechanics/MapGenerator.hpp"
+#include "mechanics/Fertility.hpp"
+#include "mechanics/Simulation.hpp"
+#include "Tools/ParallelFor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct SimulateOptions {
+    int rows = 150;
+    int cols = 250;
+    unsigned int seed = 1;
+    int worlds = 1;
+    int threads = 0;
+    long long turns = 10000;
+    int tribes = 8;
+    long long report = 1000;
+    double untilExplored = 0.0;   // stop once the player's tribe has seen this fraction; 0 = off
+    double maxSeconds = 0.0;      // 0 = no limit
+    std::string stagesPath;
+    std::vector<std::string> stages; // the order stagesPath lists, checked once in main
+};
+
+struct WorldResult {
+    unsigned int seed;
+    long long turns;
+    double generateMs;
+    double simulateSeconds;
+    double explored;
+    int villages;
+    double population;
+    std::string largestVillage;
+    bool failed;
+};
+
+static std::mutex outputMutex;
+
+static void printUsage() {
+    std::cout << "usage: simulate [--rows N] [--cols N] [--seed S] [--worlds K] [--threads T]\n"
+                 "                [--turns N] [--tribes N] [--report N] [--until-explored F]\n"
+                 "                [--max-seconds S] [--stages FILE]\n"
+                 "  --worlds K          run K worlds with seeds S..S+K-1\n"
+                 "  --threads T         worlds run in parallel on T threads (0 = all cores)\n"
+                 "  --tribes N          AI tribes besides the player's\n"
+                 "  --report N          print statistics every N turns (0 = only at the end)\n"
+                 "  --until-explored F  stop a world once the player has seen fraction F of it\n";
+}
+
+static double exploredFraction(const FogOfWarMap& fog) {
+    long long seen = 0;
+    for (const auto& row : fog.getFogGrid()) {
+        for (int state : row) seen += state != 0;
+    }
+    return static_cast<double>(seen) / (static_cast<double>(fog.getRows()) * fog.getCols());
+}
+
+// Every tribe must be on the map and on a tile it is allowed to stand on
+static bool checkInvariants(const Simulation& simulation, const std::vector<std::vector<int>>& map, std::string& why) {
+    for (const TribeState& tribe : simulation.getTribes()) {
+        if (tribe.row < 0 || tribe.row >= static_cast<int>(map.size()) ||
+            tribe.col < 0 || tribe.col >= static_cast<int>(map[0].size())) {
+            why = "tribe " + std::to_string(tribe.id) + " left the map";
+            return false;
+        }
+        int tile = map[tribe.row][tribe.col];
+        if (!Simulation::isWalkable(tile)) {
+            why = "tribe " + std::to_string(tribe.id) + " stands on tile type " + std::to_string(tile);
+            return false;
+        }
+    }
+
+    // The owner grid must agree with what each village thinks it owns
+    const VillageSystem& villages = simulation.getVillages();
+    std::vector<int> owned(villages.getCount(), 0);
+    for (int id : villages.getOwnerGrid()) {
+        if (id < -1 || id >= villages.getCount() || (id >= 0 && !villages.isAlive(id))) {
+            why = "tile owned by missing village " + std::to_string(id);
+            return false;
+        }
+        if (id >= 0) ++owned[id];
+    }
+    for (int id = 0; id < villages.getCount(); ++id) {
+        if (owned[id] != villages.getTileCounts()[id] ||
+            (villages.isAlive(id) && villages.getOwner(villages.getRows()[id], villages.getCols()[id]) != id)) {
+            why = "village " + std::to_string(id) + " territory out of sync";
+            return false;
+        }
+    }
+
+    // Territory follows the villages, and its incrementally kept borders match a full recompute
+    const TerritoryMap& territory = simulation.getTerritory();
+    for (int row = 0; row < territory.getRows(); ++row) {
+        for (int col = 0; col < territory.getCols(); ++col) {
+            int village = villages.getOwner(row, col);
+            int owner = territory.getOwner(row, col);
+            if (owner != (village == -1 ? -1 : villages.getTribes()[village])) {
+                why = "territory owner out of sync at " + std::to_string(row) + "," + std::to_string(col);
+                return false;
+            }
+            std::uint8_t expected = 0;
+            if (owner != -1) {
+                if (territory.getOwner(row - 1, col) != owner) expected |= TerritoryMap::North;
+                if (territory.getOwner(row, col + 1) != owner) expected |= TerritoryMap::East;
+                if (territory.getOwner(row + 1, col) != owner) expected |= TerritoryMap::South;
+                if (territory.getOwner(row, col - 1) != owner) expected |= TerritoryMap::West;
+            }
+            if (territory.getBorders(row, col) != expected) {
+                why = "stale border at " + std::to_string(row) + "," + std::to_string(col);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static double averageTribeFertility(const Simulation& simulation, const FertilityMap& fertility) {
+    const auto& grid = fertility.getFertilityGrid();
+    double total = 0.0;
+    for (const TribeState& tribe : simulation.getTribes()) total += grid[tribe.row][tribe.col];
+    return simulation.getTribes().empty() ? 0.0 : total / simulation.getTribes().size();
+}
+
+static WorldResult runWorld(const SimulateOptions& options, unsigned int seed, bool parallelGeneration) {
+    WorldResult result{seed, 0, 0.0, 0.0, 0.0, 0, 0.0, "", false};
+
+    auto start = std::chrono::steady_clock::now();
+    MapGenerator mapGenerator(options.rows, options.cols, seed);
+    mapGenerator.getPipeline().setOrder(options.stages);
+    // With several worlds in flight the cores are already busy
+    mapGenerator.getPipeline().setParallel(parallelGeneration);
+    mapGenerator.generateMap();
+    const auto& map = mapGenerator.getMap();
+
+    FertilityMap fertility(options.rows, options.cols);
+    fertility.generateFromTerrain(map, seed);
+    result.generateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    Simulation simulation(map, fertility, seed, options.tribes);
+    simulation.setTickRate(0.0);
+    simulation.setPlayerAutomated(true);
+
+    start = std::chrono::steady_clock::now();
+    auto lastReport = start;
+    long long lastReportTurn = 0;
+    auto elapsedSeconds = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    while (simulation.getTick() < options.turns) {
+        simulation.step();
+        long long turn = simulation.getTick();
+
+        bool reportDue = options.report > 0 && turn % options.report == 0;
+        // Invariants, exploration and the time limit are checked at every report, every
+        // 256 turns and on the last turn
+        bool checkDue = reportDue || turn % 256 == 0 || turn == options.turns;
+        if (!checkDue) continue;
+
+        std::string why;
+        if (!checkInvariants(simulation, map, why)) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "[seed " << seed << "] FAILED at turn " << turn << ": " << why << "\n";
+            result.failed = true;
+            break;
+        }
+
+        result.explored = exploredFraction(simulation.getFog());
+        if (reportDue) {
+            auto now = std::chrono::steady_clock::now();
+            double interval = std::chrono::duration<double>(now - lastReport).count();
+            double rate = interval > 0.0 ? (turn - lastReportTurn) / interval : 0.0;
+            lastReport = now;
+            lastReportTurn = turn;
+
+            std::ostringstream line;
+            line << std::fixed << "[seed " << seed << "] turn " << turn << "  " << std::setprecision(0) << rate
+                 << " turns/s  explored " << std::setprecision(1) << 100.0 * result.explored
+                 << "%  tribe fertility " << std::setprecision(3) << averageTribeFertility(simulation, fertility)
+                 << "  villages " << simulation.getVillages().getLiving() << " (pop " << std::setprecision(0)
+                 << simulation.getVillages().getTotalPopulation() << ")\n";
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << line.str();
+        }
+
+        if (options.untilExplored > 0.0 && result.explored >= options.untilExplored) break;
+        if (options.maxSeconds > 0.0 && elapsedSeconds() >= options.maxSeconds) break;
+    }
+
+    result.turns = simulation.getTick();
+    result.simulateSeconds = elapsedSeconds();
+    result.explored = exploredFraction(simulation.getFog());
+    result.villages = simulation.getVillages().getLiving();
+    result.population = simulation.getVillages().getTotalPopulation();
+    const VillageSystem& villages = simulation.getVillages();
+    auto largest = std::max_element(villages.getPopulations().begin(), villages.getPopulations().end());
+    if (largest != villages.getPopulations().end()) {
+        NameId name = villages.getNames()[largest - villages.getPopulations().begin()];
+        result.largestVillage = std::string(simulation.getNames().get(name));
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    SimulateOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--rows") options.rows = std::stoi(next());
+        else if (arg == "--cols") options.cols = std::stoi(next());
+        else if (arg == "--seed") options.seed = static_cast<unsigned int>(std::stoul(next()));
+        else if (arg == "--worlds") options.worlds = std::stoi(next());
+        else if (arg == "--threads") options.threads = std::stoi(next());
+        else if (arg == "--turns") options.turns = std::stoll(next());
+        else if (arg == "--tribes") options.tribes = std::stoi(next());
+        else if (arg == "--report") options.report = std::stoll(next());
+        else if (arg == "--until-explored") options.untilExplored = std::stod(next());
+        else if (arg == "--max-seconds") options.maxSeconds = std::stod(next());
+        else if (arg == "--stages") options.stagesPath = next();
+        else if (arg == "--help" || arg == "-h") { printUsage(); return 0; }
+        else {
+            std::cerr << "unknown argument " << arg << "\n";
+            printUsage();
+            return 2;
+        }
+    }
+    if (options.worlds < 1 || options.rows < 1 || options.cols < 1) {
+        std::cerr << "--worlds, --rows and --cols must be positive\n";
+        return 2;
+    }
+    MapGenerator probe(1, 1, options.seed);
+    if (!options.stagesPath.empty() && !probe.loadStageConfig(options.stagesPath)) return 2;
+    options.stages = probe.getPipeline().getOrder();
+
+    std::vector<WorldResult> results(options.worlds);
+    auto start = std::chrono::steady_clock::now();
+    parallelFor(options.worlds, options.threads, [&](int i) {
+        results[i] = runWorld(options, options.seed + i, options.worlds == 1);
+    });
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long totalTurns = 0;
+    int failures = 0;
+    std::cout << "\n" << std::left << std::setw(12) << "seed" << std::right << std::setw(10) << "turns"
+              << std::setw(12) << "gen ms" << std::setw(14) << "turns/s" << std::setw(11) << "explored"
+              << std::setw(10) << "villages" << std::setw(12) << "population"
+              << "  largest village\n";
+    for (const WorldResult& r : results) {
+        totalTurns += r.turns;
+        failures += r.failed;
+        std::cout << std::left << std::setw(12) << r.seed << std::right << std::setw(10) << r.turns
+                  << std::setw(12) << std::fixed << std::setprecision(1) << r.generateMs
+                  << std::setw(14) << std::setprecision(0) << (r.simulateSeconds > 0.0 ? r.turns / r.simulateSeconds : 0.0)
+                  << std::setw(10) << std::setprecision(1) << 100.0 * r.explored << "%"
+                  << std::setw(10) << r.villages << std::setw(12) << std::setprecision(0) << r.population
+                  << "  " << r.largestVillage
+                  << (r.failed ? "  FAILED" : "") << "\n";
+    }
+    std::cout << options.worlds << " worlds, " << totalTurns << " turns in " << std::setprecision(2) << wallSeconds
+              << " s (" << std::setprecision(0) << totalTurns / wallSeconds << " turns/s overall)\n";
+
+    return failures == 0 ? 0 : 1;
+}
@@ -1,21 +1,30 @@
 #include "mechanics/MapGenerator.hpp"
+#include "mechanics/WorldBuilder.hpp"
 #include "mechanics/Fertility.hpp"
 #include "mechanics/FoW.hpp"
 #include "mechanics/Tribe.hpp"
-#include "Tools/UITools.hpp"
+#include "mechanics/Simulation.hpp"
+#include "Tools/UILayer.hpp"
+#include "Tools/InputBindings.hpp"
+#include "Tools/InputSystem.hpp"
+#include "Tools/CameraController.hpp"
+#include "Tools/TilePicker.hpp"
+#include "Tools/BorderRenderer.hpp"
 #include "Tools/MapTools.hpp"
 #include "Tools/ObjectTools.hpp"
+#include "Tools/OverlayTools.hpp"
+#include "Tools/Profiler.hpp"
+#include "Tools/ProfilerOverlay.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <iostream>
 #include <optional>
-#include <unordered_map>
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <random>
 
 int main() {
-    sf::Clock buttonCooldownClock;
-    const float buttonCooldown = 0.1f;
-
     sf::Font font;
     if (!font.openFromFile("../resources/AovelSansRounded-rdDL.ttf")) {
         std::cerr << "Failed to load font\n";
@@ -29,181 +38,335 @@ int main() {
     const int cols = 250;
     float dimension = 2000.0f / cols;
     const float cellSize = dimension;
-    bool MenuOpen = false;
 
     // --- Map and overlays ---
-    MapGenerator mapGenerator(rows, cols);
-    mapGenerator.generateMap();
-    const std::vector<std::vector<int>>& map = mapGenerator.getMap();
-    sf::VertexArray grid = mapGenerator.createGrid(cellSize);
-
-    FertilityMap fertility(rows, cols);
-    fertility.generateFromTerrain(map);
-    sf::VertexArray fertilityOverlay = fertility.createFertilityOverlay(cellSize);
-
-    FogOfWarMap fog(rows, cols);
-
-    Tribe playerTribe(rows, cols);
-    playerTribe.spawn(map); // Pick a random land tile
-    playerTribe.revealFoW(fog.getFogGrid()); // Reveal fog within radius
-
-    sf::VertexArray fogOverlay = fog.createFogOverlay(cellSize);
-    sf::RectangleShape playerMarker = playerTribe.getPlayerMarker(cellSize);
+    // Generation runs in the background; the grid shows each stage as it finishes
+    WorldBuilder worldBuilder(rows, cols, cellSize);
+    worldBuilder.setStageConfig("../resources/pipeline.cfg");
+    worldBuilder.start(std::random_device{}());
 
-    // Center the view on the player
-    float playerX = playerTribe.getCol() * cellSize + cellSize / 2.f;
-    float playerY = playerTribe.getRow() * cellSize + cellSize / 2.f;
+    std::unique_ptr<WorldData> world;
+    sf::VertexArray grid;
+    int previewVersion = 0;
 
+    // Game state ticks on its own thread once a world exists; each frame draws
+    // the newest snapshot, interpolating tribe positions between ticks
+    std::unique_ptr<Simulation> simulation;
+    const double simulationTickRate = 4.0;
+    const int aiTribeCount = 4;
 
+    std::shared_ptr<const FogOfWarMap> drawnFog; // fog the overlay was built from
+    sf::VertexArray fogOverlay;
+    BorderRenderer borders(cellSize); // only chunks whose borders moved are rebuilt
 
+    Tribe playerTribe(rows, cols);
+    sf::RectangleShape tribeMarker({cellSize, cellSize});
+    tribeMarker.setOutlineColor(sf::Color::White); // outlined when drag-selected
+    sf::CircleShape villageMarker(cellSize / 2.f, 12);
+    villageMarker.setOutlineColor(sf::Color::Black);
+    villageMarker.setOutlineThickness(cellSize / 10.f);
+
+    playerTribe.setSettleHandler([&]() {
+        if (simulation) simulation->post({SimCommand::FoundVillage, 0, playerTribe.getRow(), playerTribe.getCol()});
+    });
+    float playerX = 0.f;
+    float playerY = 0.f;
+
+    // --- Progress view (drawn in screen space while generating) ---
+    sf::RectangleShape progressBack({600.f, 30.f});
+    progressBack.setPosition({600.f, 800.f});
+    progressBack.setFillColor(sf::Color(50, 50, 50, 200));
+    progressBack.setOutlineColor(sf::Color::White);
+    progressBack.setOutlineThickness(2.f);
+    sf::RectangleShape progressFill({0.f, 30.f});
+    progressFill.setPosition({600.f, 800.f});
+    progressFill.setFillColor(sf::Color(200, 200, 200, 220));
+    sf::Text progressText(font, "", 24);
+    progressText.setPosition({600.f, 760.f});
+    progressText.setFillColor(sf::Color::White);
 
     bool showFog = true;
     bool showFertility = false;
 
     // --- Camera setup ---
-    sf::View view = window.getView();
-    sf::Vector2f targetCenter = view.getCenter();
-    // float targetZoom = 1.0f;
-    const float panSpeed = 500.0f;
-    const float zoomSpeed = 2.0f;
-    const float smoothingFactor = 0.5f;
-
-    targetCenter = {playerX, playerY};
-
-    // Zoom in
-    float targetZoom = 0.1f;
-
-    std::unordered_map<sf::Keyboard::Scancode, bool> keyStates = {
-        {sf::Keyboard::Scancode::A, false},
-        {sf::Keyboard::Scancode::D, false},
-        {sf::Keyboard::Scancode::W, false},
-        {sf::Keyboard::Scancode::S, false},
-        {sf::Keyboard::Scancode::N, false},
-        {sf::Keyboard::Scancode::M, false}
-    };
+    sf::View view = window.getDefaultView();
+    const sf::Vector2f mapCenter = {cols * cellSize / 2.f, rows * cellSize / 2.f};
+    CameraController camera({{0.f, 0.f}, {cols * cellSize, rows * cellSize}}, window.getDefaultView().getSize());
 
-    sf::Clock clock;
-    UITools UITools(font);
+    // Show the whole map while it generates
+    camera.setTarget(mapCenter, 1.2f);
 
-    // --- UI buttons ---
-    UIButton fertilityToggleButton({-700.f, 300.f}, {200.f, 50.f}, font, "Toggle Fertility", false, 50);
-    UIButton fogToggleButton({-700.f, 370.f}, {200.f, 50.f}, font, "Toggle Fog", false, 50);
+    InputBindings bindings;
+    bindings.loadConfig("../resources/controls.cfg");
 
-    // Calculate world position above the tribe tile
-    sf::Vector2f tribePos(
-        playerTribe.getCol() * cellSize + cellSize / 2.f - 50.f,
-        playerTribe.getRow() * cellSize - cellSize / 2.f - 25.f // one cell above
-    );
+    sf::Clock clock;
+
+    // F3 shows frame timings, F4 writes a Chrome trace of what has been recorded
+    Profiler::setThreadName("main");
+    ProfilerOverlay profilerOverlay(font);
 
-    UIButton tribeButton(tribePos, {100.f, 20.f}, font, "Tribe Action", true, 30);
+    // --- UI ---
+    // Widgets are created once; the tribe ones are placed and shown when a world is ready
+    UILayer ui(font);
+    ui.addButton(UISpace::Screen, {{200.f, 750.f}, {200.f, 50.f}}, "Toggle Fertility", 50,
+                 [&]() { showFertility = !showFertility; });
+    ui.addButton(UISpace::Screen, {{200.f, 820.f}, {200.f, 50.f}}, "Toggle Fog", 50,
+                 [&]() { showFog = !showFog; });
 
     bool tribeMenuOpen = false;
+    UILayer::WidgetId tribeMenu = playerTribe.createTribeMenu(ui, cellSize);
+    UILayer::WidgetId tribeButton = ui.addButton(UISpace::World, {{0.f, 0.f}, {100.f, 20.f}}, "Tribe Action", 30,
+                                                 [&]() {
+                                                     tribeMenuOpen = !tribeMenuOpen;
+                                                     ui.setVisible(tribeMenu, tribeMenuOpen);
+                                                 });
+    ui.setVisible(tribeButton, false);
+
+    InputSystem input(ui, bindings);
+    TilePicker picker(rows, cols, cellSize);
+
+    // A short left press and release on the map is a click; a longer drag selects tribes
+    const float dragThreshold = 4.f;
+    bool dragging = false;
+    sf::Vector2i dragStart;
+    bool mapClicked = false;
+    std::vector<int> selectedTribes;
+    sf::RectangleShape selectionBox;
+    selectionBox.setFillColor(sf::Color(255, 255, 255, 40));
+    selectionBox.setOutlineColor(sf::Color::White);
+
+    // Keeps the tribe button and menu above the player's tribe
+    auto placeTribeUI = [&]() {
+        playerX = playerTribe.getCol() * cellSize + cellSize / 2.f;
+        playerY = playerTribe.getRow() * cellSize + cellSize / 2.f;
+
+        // Calculate world position above the tribe tile
+        sf::Vector2f tribePos(
+            playerTribe.getCol() * cellSize + cellSize / 2.f - 50.f,
+            playerTribe.getRow() * cellSize - cellSize / 2.f - 25.f // one cell above
+        );
+        ui.setPosition(tribeButton, tribePos);
+
+        // Position the menu near the tribe button (e.g. right below)
+        ui.setPosition(tribeMenu, tribePos + sf::Vector2f(2.f, -155.f));
+    };
 
-    sf::RectangleShape tribeMenuShape;
-    // Position the menu near the tribe button (e.g. right below)
-    sf::Vector2f tribeMenuPos = tribePos + sf::Vector2f(2.f, -155.f);
+    // Called on the render thread once the builder hands over a finished world
+    auto onWorldReady = [&]() {
+        grid.clear(); // The preview is replaced by the LOD terrain
+
+        simulation = std::make_unique<Simulation>(world->map, world->fertility, world->seed, aiTribeCount);
+        simulation->setTickRate(simulationTickRate);
+        const TribeState& player = simulation->getTribes()[0]; // Spawned on a random land tile
+        playerTribe.setPosition(player.row, player.col);
+        // Names are read before the thread starts adding to them
+        ui.setLabel(tribeButton, std::string(simulation->getNames().get(player.name)));
+        simulation->start();
+        drawnFog.reset();
+        borders.reset();
+
+        placeTribeUI();
+        ui.setVisible(tribeButton, true);
+        tribeMenuOpen = false;
+        ui.setVisible(tribeMenu, false);
+
+        // Center the view on the player and zoom in
+        camera.setTarget({playerX, playerY}, 0.1f);
+    };
+
+    // Throws away the current world and generates a new one with a fresh seed
+    auto regenerate = [&]() {
+        simulation.reset();
+        world.reset();
+        selectedTribes.clear();
+        playerTribe.endMoveMode();
+        ui.setVisible(tribeButton, false);
+        ui.setVisible(tribeMenu, false);
+        tribeMenuOpen = false;
+        camera.setTarget(mapCenter, 1.2f);
+        worldBuilder.start(std::random_device{}());
+    };
 
 
     while (window.isOpen()) {
+        PROFILE_SCOPE("frame");
+
+        input.beginFrame();
+        mapClicked = false;
         while (const std::optional event = window.pollEvent()) {
+            if (input.handleEvent(*event, window, view)) {
+                continue; // A widget took it
+            }
             if (event->is<sf::Event::Closed>()) {
                 window.close();
             }
-            // if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Left)) {
-            //     auto [row, col] = windowToTile(window, cellSize);
-            //     std::cout << "Clicked tile at (" << row << ", " << col << ")\n";
-            // }
-            if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
-                if (keyPressed->scancode == sf::Keyboard::Scancode::Escape) {
-                    window.close();
-                } else {
-                    keyStates[keyPressed->scancode] = true;
+            if (const auto* press = event->getIf<sf::Event::MouseButtonPressed>()) {
+                if (press->button == sf::Mouse::Button::Left) {
+                    dragging = true;
+                    dragStart = press->position;
+                }
+            } else if (const auto* release = event->getIf<sf::Event::MouseButtonReleased>()) {
+                if (release->button == sf::Mouse::Button::Left && dragging) {
+                    dragging = false;
+                    sf::Vector2f moved(release->position - dragStart);
+                    if (std::abs(moved.x) < dragThreshold && std::abs(moved.y) < dragThreshold) {
+                        mapClicked = true;
+                    } else if (simulation) {
+                        TileRect rect = picker.pickRect(window.mapPixelToCoords(dragStart, view),
+                                                        window.mapPixelToCoords(release->position, view));
+                        selectedTribes.clear();
+                        for (const TribeState& tribe : simulation->latestSnapshot().tribes) {
+                            if (rect.contains(tribe.row, tribe.col)) selectedTribes.push_back(tribe.id);
+                        }
+                    }
                 }
-            } else if (const auto* keyReleased = event->getIf<sf::Event::KeyReleased>()) {
-                keyStates[keyReleased->scancode] = false;
             }
         }
 
-        float deltaTime = clock.restart().asSeconds();
+        if (input.wasActionPressed(Action::Quit)) {
+            window.close();
+        }
+        if (input.wasActionPressed(Action::Regenerate)) {
+            regenerate();
+        }
+        if (input.wasActionPressed(Action::ToggleProfiler)) {
+            profilerOverlay.toggle();
+        }
+        if (input.wasActionPressed(Action::WriteTrace)) {
+            if (Profiler::writeChromeTrace("profile_trace.json")) {
+                std::cout << "Wrote profile_trace.json\n";
+            }
+        }
 
-        if (keyStates[sf::Keyboard::Scancode::A] && !MenuOpen) targetCenter.x -= panSpeed * deltaTime;
-        if (keyStates[sf::Keyboard::Scancode::D] && !MenuOpen) targetCenter.x += panSpeed * deltaTime;
-        if (keyStates[sf::Keyboard::Scancode::W] && !MenuOpen) targetCenter.y -= panSpeed * deltaTime;
-        if (keyStates[sf::Keyboard::Scancode::S] && !MenuOpen) targetCenter.y += panSpeed * deltaTime;
-        if (keyStates[sf::Keyboard::Scancode::N] && !MenuOpen) targetZoom -= zoomSpeed * deltaTime;
-        if (keyStates[sf::Keyboard::Scancode::M] && !MenuOpen) targetZoom += zoomSpeed * deltaTime;
+        float deltaTime = clock.restart().asSeconds();
 
-        // Smooth camera movement
-        sf::Vector2f interpolatedCentre = view.getCenter() + smoothingFactor * (targetCenter - view.getCenter());
-        view.setCenter(interpolatedCentre);
+        sf::Vector2f pan = {input.axis(Action::PanLeft, Action::PanRight), input.axis(Action::PanUp, Action::PanDown)};
+        camera.update(deltaTime, pan, input.axis(Action::ZoomIn, Action::ZoomOut));
+        camera.apply(view);
 
-        float currentZoom = view.getSize().x / window.getView().getSize().x;
-        float interpolatedZoom = currentZoom + smoothingFactor * (targetZoom - currentZoom);
-        view.setSize(window.getDefaultView().getSize() * interpolatedZoom);
+        // Hover follows the camera; clicks were dispatched with the events
+        input.update(window, view);
+        picker.update(window, view, input.getMousePixel(), input.isMouseInside() && !input.isPointerOverUI());
 
         window.setView(view);
         window.clear();
 
-        window.draw(grid);
-
-        if (showFertility) {
-            window.draw(fertilityOverlay);
+        if (!world) {
+            worldBuilder.pollPreview(previewVersion, grid);
+            world = worldBuilder.takeResult();
+            if (world) onWorldReady();
         }
 
-        window.draw(getHoveredTileHighlight(window, view, cellSize));
-
-        window.draw(playerMarker); // <- draw tribe marker
+        if (world) {
+            world->terrain.draw(window, view);
+        } else {
+            PROFILE_SCOPE("draw grid");
+            drawCounted(window, grid);
+        }
 
-        if (showFog) {
-            fogOverlay = fog.createFogOverlay(cellSize); // regenerate
-            window.draw(fogOverlay);
+        if (!world) {
+            // --- Progress view ---
+            window.setView(window.getDefaultView());
+            progressFill.setSize({600.f * worldBuilder.getProgress(), 30.f});
+            progressText.setString("Generating world: " + worldBuilder.getStatus());
+            window.draw(progressBack);
+            window.draw(progressFill);
+            window.draw(progressText);
+            profilerOverlay.draw(window);
+            window.display();
+            Profiler::endFrame();
+            continue;
         }
 
+        if (showFertility) {
+            PROFILE_SCOPE("draw fertility");
+            drawCounted(window, world->fertilityOverlay);
+        }
 
+        if (picker.hovered().valid) {
+            drawCounted(window, picker.getHoverHighlight());
+        }
 
-        // --- Handle UI ---
-        UITools.ButtonTransform(fertilityToggleButton, view, window);
-        if (UITools.drawButton(window, "Toggle Fertility", fertilityToggleButton)) {
-            if (buttonCooldownClock.getElapsedTime().asSeconds() > buttonCooldown) {
-                showFertility = !showFertility;
-                buttonCooldownClock.restart();
+        // Clicking a highlighted tile in move mode asks the simulation to move the tribe
+        if (mapClicked && playerTribe.isMoveModeActive()) {
+            const TilePick& pick = picker.hovered();
+            if (pick.valid && playerTribe.canMoveTo(pick.row, pick.col)) {
+                simulation->post({SimCommand::MoveTribe, 0, pick.row, pick.col});
             }
+            playerTribe.endMoveMode();
         }
 
-        UITools.ButtonTransform(fogToggleButton, view, window);
-        if (UITools.drawButton(window, "Toggle Fog", fogToggleButton)) {
-            if (buttonCooldownClock.getElapsedTime().asSeconds() > buttonCooldown) {
-                showFog = !showFog;
-                buttonCooldownClock.restart();
-            }
+        const WorldSnapshot& snapshot = simulation->latestSnapshot();
+        const float alpha = Simulation::interpolation(snapshot);
+
+        const TribeState& player = snapshot.tribes[0];
+        if (player.row != playerTribe.getRow() || player.col != playerTribe.getCol()) {
+            playerTribe.setPosition(player.row, player.col);
+            placeTribeUI();
         }
 
+        if (snapshot.territory) {
+            borders.update(*snapshot.territory);
+            borders.draw(window, view);
+        }
 
-        UITools.ButtonTransform(tribeButton, view, window);
-        if (UITools.drawButton(window, "Tribe Action", tribeButton)) {
-            if (buttonCooldownClock.getElapsedTime().asSeconds() > buttonCooldown) {
-                tribeMenuOpen = !tribeMenuOpen;
-                buttonCooldownClock.restart();
-            }
+        // --- Villages, sized by population ---
+        for (const VillageState& village : snapshot.villages) {
+            float radius = cellSize * std::clamp(0.3f + village.population / 400.f, 0.3f, 1.2f);
+            villageMarker.setRadius(radius);
+            villageMarker.setOrigin({radius, radius});
+            villageMarker.setPosition({(village.col + 0.5f) * cellSize, (village.row + 0.5f) * cellSize});
+            villageMarker.setFillColor(village.tribe == 0 ? sf::Color(200, 120, 220) : sf::Color(240, 190, 90));
+            drawCounted(window, villageMarker);
         }
 
-        const float buttonCooldown2 = 2.f;
+        // --- Tribe markers ---
+        for (const TribeState& tribe : snapshot.tribes) {
+            float row = tribe.previousRow + (tribe.row - tribe.previousRow) * alpha;
+            float col = tribe.previousCol + (tribe.col - tribe.previousCol) * alpha;
+            tribeMarker.setPosition({col * cellSize, row * cellSize});
+            tribeMarker.setFillColor(tribe.ai ? sf::Color(230, 120, 0, 200) : sf::Color(128, 0, 128, 180));
+            bool selected = std::find(selectedTribes.begin(), selectedTribes.end(), tribe.id) != selectedTribes.end();
+            tribeMarker.setOutlineThickness(selected ? cellSize / 6.f : 0.f);
+            drawCounted(window, tribeMarker);
+        }
 
-        if (tribeMenuOpen) {
-            if (buttonCooldownClock.getElapsedTime().asSeconds() > buttonCooldown) {
-                bool moveClicked = playerTribe.drawTribeMenu(UITools, window, view, tribeMenuPos, font, cellSize, {playerX, playerY});
+        if (showFog) {
+            // Rebuilt only when a tick changed what the player has seen
+            if (snapshot.fog != drawnFog) {
+                PROFILE_SCOPE("fog rebuild");
+                fogOverlay = createFogOverlay(*snapshot.fog, cellSize);
+                drawnFog = snapshot.fog;
             }
+            PROFILE_SCOPE("draw fog");
+            drawCounted(window, fogOverlay);
         }
 
-        sf::Vector2f worldPos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
 
+
+        if (dragging) {
+            sf::Vector2f corner = window.mapPixelToCoords(dragStart, view);
+            sf::Vector2f mouse = window.mapPixelToCoords(input.getMousePixel(), view);
+            selectionBox.setPosition({std::min(corner.x, mouse.x), std::min(corner.y, mouse.y)});
+            selectionBox.setSize({std::abs(mouse.x - corner.x), std::abs(mouse.y - corner.y)});
+            selectionBox.setOutlineThickness(view.getSize().x / window.getSize().x);
+            drawCounted(window, selectionBox);
+        }
+
+        // --- Handle UI ---
         playerTribe.drawMoveHighlights(window);
 
         // sf::RectangleShape tribeSprite = placeObjectAt(playerTribe.getCol(), playerTribe.getRow(), cellSize, sf::Color::Red);
         // drawObject(window, tribeSprite);
 
 
-        window.display();
+        ui.draw(window, view);
+        profilerOverlay.draw(window);
+        {
+            PROFILE_SCOPE("display");
+            window.display();
+        }
+        Profiler::endFrame();
     }
 
     return 0;
@@ -0,0 +1,116 @@
+#include "Climate.hpp"
+#include "DistanceField.hpp"
+#include "../Tools/ParallelFor.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+// Open water that feeds moisture: sea, lake, river, coast, ocean
+static bool isWater(int tile) {
+    return tile == 0 || tile == 16 || tile == 6 || tile == 22 || tile == 23;
+}
+
+// Prevailing wind for a latitude (0 = equator, 1 = pole): +1 blows towards
+// higher columns (westerlies), -1 towards lower ones (trades, polar easterlies)
+static int windDirection(float latitude) {
+    return latitude >= 1.f / 3.f && latitude < 2.f / 3.f ? 1 : -1;
+}
+
+ClimateField computeClimate(const std::vector<std::vector<int>>& map, std::span<const float> height, int threads,
+                            std::pmr::memory_resource* resource) {
+    PROFILE_SCOPE("computeClimate");
+    ClimateField climate{0, 0, std::pmr::vector<float>(resource), std::pmr::vector<float>(resource)};
+    climate.rows = static_cast<int>(map.size());
+    climate.cols = climate.rows > 0 ? static_cast<int>(map[0].size()) : 0;
+    const int rows = climate.rows, cols = climate.cols;
+    climate.temperature.assign(static_cast<std::size_t>(rows) * cols, 0.f);
+    climate.moisture.assign(static_cast<std::size_t>(rows) * cols, 0.f);
+    if (rows == 0 || cols == 0) return climate;
+
+    std::pmr::vector<std::uint8_t> water(static_cast<std::size_t>(rows) * cols, resource);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) water[r * cols + c] = isWater(map[r][c]);
+    }
+    const DistanceField toWater = distanceTransform(water, rows, cols, DistanceMetric::Euclidean, threads, resource);
+
+    // Lengths scale with the map so climate bands keep their shape at any size
+    const float span = static_cast<float>(std::max(rows, cols));
+    const float inland = std::max(4.f, span / 40.f); // falloff of nearness to water
+    const float rainout = 8.f / span;                 // vapour lost per tile over flat land
+    const float mid = 0.5f * static_cast<float>(rows - 1);
+
+    parallelFor(rows, threads, [&](int r) {
+        const float latitude = mid > 0.f ? std::abs(static_cast<float>(r) - mid) / mid : 0.f;
+        const int direction = windDirection(latitude);
+        float* temperature = &climate.temperature[static_cast<std::size_t>(r) * cols];
+        float* moisture = &climate.moisture[static_cast<std::size_t>(r) * cols];
+        const float* ground = &height[static_cast<std::size_t>(r) * cols];
+
+        // Temperature: warm equator, cold poles, colder with height
+        for (int c = 0; c < cols; ++c) {
+            temperature[c] = 27.f - 42.f * latitude * latitude - 25.f * ground[c];
+        }
+
+        // Moisture: carry vapour downwind along the row
+        float vapour = 0.f;
+        float previousHeight = 0.f;
+        for (int i = 0; i < cols; ++i) {
+            const int c = direction > 0 ? i : cols - 1 - i;
+            if (water[static_cast<std::size_t>(r) * cols + c]) {
+                vapour += 0.15f * (1.f - vapour);
+                previousHeight = 0.f;
+                moisture[c] = 1.f;
+                continue;
+            }
+
+            const float lift = std::max(0.f, ground[c] - previousHeight);
+            const float rain = std::min(vapour, vapour * (rainout + 2.f * lift));
+            const float distance = toWater.at(r, c);
+            const float nearness = std::isinf(distance) ? 0.f : std::exp(-distance / inland);
+            moisture[c] = std::clamp(0.45f * nearness + 0.6f * vapour, 0.f, 1.f);
+            vapour -= rain;
+            previousHeight = ground[c];
+        }
+    });
+    return climate;
+}
+
+// Temperature bands (upper bounds) and moisture bands (fifths of 0..1)
+static const float TemperatureBands[] = {FreezingTemperature, 0.f, 7.f, 17.f, 23.f};
+static const int TemperatureBandCount = 6;
+static const int MoistureBandCount = 5;
+
+// Lowland tile per band: 7 ice, 8 tundra, 10 taiga, 1 grassland, 12 desert, 18 forest, 20 jungle
+static const int WhittakerTable[TemperatureBandCount][MoistureBandCount] = {
+    // arid  dry  moderate  wet  very wet
+    {7, 7, 7, 7, 7},          // frozen
+    {8, 8, 8, 8, 10},         // cold
+    {8, 1, 10, 10, 10},       // boreal
+    {12, 1, 1, 18, 18},       // temperate
+    {12, 12, 1, 18, 20},      // warm
+    {12, 12, 1, 20, 20},      // hot
+};
+
+// Hill version of a lowland tile
+static int hillVariant(int tile) {
+    switch (tile) {
+        case 1: return 2;
+        case 8: return 9;
+        case 10: return 11;
+        case 12: return 13;
+        case 18: return 19;
+        case 20: return 21;
+        default: return tile;
+    }
+}
+
+int whittakerBiome(int baseTile, float temperature, float moisture) {
+    int band = 0;
+    while (band < TemperatureBandCount - 1 && temperature >= TemperatureBands[band]) ++band;
+    const int wetness = std::clamp(static_cast<int>(moisture * MoistureBandCount), 0, MoistureBandCount - 1);
+    const int tile = WhittakerTable[band][wetness];
+    return baseTile == 2 ? hillVariant(tile) : tile;
+}
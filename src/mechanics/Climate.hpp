@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+// Per-tile climate, row-major. Temperature is in rough degrees Celsius,
+// moisture runs from 0 (arid) to 1 (saturated).
+struct ClimateField {
+    int rows = 0, cols = 0;
+    std::pmr::vector<float> temperature;
+    std::pmr::vector<float> moisture;
+
+    float temperatureAt(int row, int col) const { return temperature[row * cols + col]; }
+    float moistureAt(int row, int col) const { return moisture[row * cols + col]; }
+};
+
+// Temperature falls off with latitude and with height. Moisture mixes
+// nearness to open water with vapour carried along each row by the prevailing
+// wind for its latitude band (easterly trades, westerlies, polar easterlies):
+// water tops the vapour up, land rains it out, and climbing ground rains out
+// more, leaving a drier lee. `height` holds a value per tile, row-major, from 0
+// at sea level to 1 on the highest ground. Both passes run a row at a time over
+// `threads` threads (0 = one per core); the result doesn't depend on the thread
+// count. The fields and the working arrays come from `resource`.
+ClimateField computeClimate(const std::vector<std::vector<int>>& map, std::span<const float> height, int threads = 0,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+// Whittaker-style lookup: the tile a land (1) or hill (2) tile becomes at this
+// temperature and moisture. Ice (7) below freezing whatever the base tile.
+int whittakerBiome(int baseTile, float temperature, float moisture);
+
+// Below this the sea freezes over and land becomes ice cap
+constexpr float FreezingTemperature = -12.f;
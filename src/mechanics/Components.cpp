@@ -0,0 +1,140 @@
+#include "Components.hpp"
+#include "../Tools/ParallelFor.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+
+struct Run {
+    int row;
+    int begin; // first column
+    int end;   // last column, inclusive
+};
+
+// Union-find over run indices. The smaller index always becomes the root, so a
+// component's root is its first run in scan order whatever order unions happen in.
+static int findRoot(std::pmr::vector<int>& parent, int run) {
+    while (parent[run] != run) {
+        parent[run] = parent[parent[run]];
+        run = parent[run];
+    }
+    return run;
+}
+
+static void unite(std::pmr::vector<int>& parent, int a, int b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a == b) return;
+    if (a < b) parent[b] = a;
+    else parent[a] = b;
+}
+
+// Joins the runs of one row with the runs of the row above that touch them
+static void uniteRows(const std::pmr::vector<Run>& runs, std::pmr::vector<int>& parent, int aboveBegin, int aboveEnd,
+                      int rowBegin, int rowEnd, int reach) {
+    int above = aboveBegin;
+    for (int run = rowBegin; run < rowEnd; ++run) {
+        // Skip runs above that end before this one can touch them
+        while (above < aboveEnd && runs[above].end + reach < runs[run].begin) ++above;
+        for (int other = above; other < aboveEnd && runs[other].begin <= runs[run].end + reach; ++other) {
+            unite(parent, run, other);
+        }
+    }
+}
+
+ComponentLabels labelMask(std::span<const std::uint8_t> mask, int rows, int cols, Connectivity connectivity,
+                          int threads, std::pmr::memory_resource* resource) {
+    PROFILE_SCOPE("labelMask");
+    ComponentLabels result{0, 0, std::pmr::vector<int>(resource), std::pmr::vector<Component>(resource)};
+    result.rows = rows;
+    result.cols = cols;
+    result.labels.assign(static_cast<std::size_t>(rows) * cols, -1);
+    if (rows == 0 || cols == 0) return result;
+
+    // Diagonal neighbours count as touching when they are one column past the run
+    const int reach = connectivity == Connectivity::Eight ? 1 : 0;
+    const int bandCount = std::max(1, std::min(threads <= 0 ? 64 : threads, rows / 16));
+    const int bandRows = (rows + bandCount - 1) / bandCount;
+
+    // Pass 1a: count runs per row, then lay them out in one array
+    std::pmr::vector<int> rowStart(rows + 1, 0, resource);
+    parallelFor(bandCount, threads, [&](int band) {
+        for (int r = band * bandRows; r < std::min(rows, (band + 1) * bandRows); ++r) {
+            const std::uint8_t* line = &mask[static_cast<std::size_t>(r) * cols];
+            int count = 0;
+            for (int c = 0; c < cols; ++c) count += line[c] && (c == 0 || !line[c - 1]);
+            rowStart[r + 1] = count;
+        }
+    });
+    for (int r = 0; r < rows; ++r) rowStart[r + 1] += rowStart[r];
+
+    std::pmr::vector<Run> runs(rowStart[rows], resource);
+    std::pmr::vector<int> parent(runs.size(), resource);
+
+    // Pass 1b: each band cuts its rows into runs and joins them inside the band
+    parallelFor(bandCount, threads, [&](int band) {
+        const int first = band * bandRows;
+        const int last = std::min(rows, (band + 1) * bandRows);
+        for (int r = first; r < last; ++r) {
+            const std::uint8_t* line = &mask[static_cast<std::size_t>(r) * cols];
+            int index = rowStart[r];
+            for (int c = 0; c < cols;) {
+                if (!line[c]) { ++c; continue; }
+                int begin = c;
+                while (c < cols && line[c]) ++c;
+                runs[index] = {r, begin, c - 1};
+                parent[index] = index;
+                ++index;
+            }
+            if (r > first) uniteRows(runs, parent, rowStart[r - 1], rowStart[r], rowStart[r], rowStart[r + 1], reach);
+        }
+    });
+
+    // Merge: stitch each band to the one above along the seam
+    for (int band = 1; band < bandCount; ++band) {
+        const int r = band * bandRows;
+        if (r >= rows) break;
+        uniteRows(runs, parent, rowStart[r - 1], rowStart[r], rowStart[r], rowStart[r + 1], reach);
+    }
+
+    // Pass 2: number the roots in scan order and gather statistics per run
+    std::pmr::vector<int> componentOf(runs.size(), resource);
+    std::pmr::vector<double> rowSums(resource), colSums(resource);
+    for (int run = 0; run < static_cast<int>(runs.size()); ++run) {
+        int root = findRoot(parent, run);
+        const Run& span = runs[run];
+        const int length = span.end - span.begin + 1;
+
+        int id;
+        if (root == run) {
+            id = static_cast<int>(result.components.size());
+            Component component;
+            component.minRow = component.maxRow = span.row;
+            component.minCol = span.begin;
+            component.maxCol = span.end;
+            result.components.push_back(component);
+            rowSums.push_back(0.0);
+            colSums.push_back(0.0);
+        } else {
+            id = componentOf[root];
+        }
+        componentOf[run] = id;
+
+        Component& component = result.components[id];
+        component.size += length;
+        component.minRow = std::min(component.minRow, span.row);
+        component.maxRow = std::max(component.maxRow, span.row);
+        component.minCol = std::min(component.minCol, span.begin);
+        component.maxCol = std::max(component.maxCol, span.end);
+        rowSums[id] += static_cast<double>(span.row) * length;
+        colSums[id] += (span.begin + span.end) * 0.5 * length;
+
+        std::fill_n(result.labels.begin() + static_cast<std::size_t>(span.row) * cols + span.begin, length, id);
+    }
+
+    for (std::size_t id = 0; id < result.components.size(); ++id) {
+        Component& component = result.components[id];
+        component.centroidRow = static_cast<float>(rowSums[id] / component.size);
+        component.centroidCol = static_cast<float>(colSums[id] / component.size);
+    }
+    return result;
+}
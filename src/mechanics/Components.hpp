@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+enum class Connectivity { Four, Eight };
+
+struct Component {
+    int size = 0;
+    int minRow = 0, minCol = 0, maxRow = 0, maxCol = 0; // bounding box, inclusive
+    float centroidRow = 0.f, centroidCol = 0.f;
+};
+
+// Result of labelling: every tile that matched gets the index of its component,
+// numbered in the order their first tile appears in a row-major scan.
+struct ComponentLabels {
+    int rows = 0, cols = 0;
+    std::pmr::vector<int> labels;            // row-major, -1 = tile didn't match
+    std::pmr::vector<Component> components;
+
+    int at(int row, int col) const { return labels[row * cols + col]; }
+};
+
+// Connected-component labelling over a row-major 0/1 mask. Each row is cut into
+// runs of matching tiles, runs that touch the row above are joined with
+// union-find, and a final pass over the runs writes labels and per-component
+// statistics, so the work is linear in tiles. With threads > 1 the rows are
+// split into bands that are labelled independently and then stitched together
+// along the band seams. The result doesn't depend on the thread count.
+// The result and the working arrays come from `resource`.
+ComponentLabels labelMask(std::span<const std::uint8_t> mask, int rows, int cols, Connectivity connectivity,
+                          int threads = 1, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+// Labels the tiles of a map whose type satisfies the predicate
+template <typename Predicate>
+ComponentLabels labelComponents(const std::vector<std::vector<int>>& map, Predicate matches,
+                                Connectivity connectivity = Connectivity::Eight, int threads = 1,
+                                std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = rows > 0 ? static_cast<int>(map[0].size()) : 0;
+    std::pmr::vector<std::uint8_t> mask(static_cast<std::size_t>(rows) * cols, resource);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) mask[r * cols + c] = matches(map[r][c]) ? 1 : 0;
+    }
+    return labelMask(mask, rows, cols, connectivity, threads, resource);
+}
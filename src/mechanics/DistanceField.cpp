@@ -0,0 +1,148 @@
+#include "DistanceField.hpp"
+#include "../Tools/ParallelFor.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static const int ColumnBand = 256;
+
+// Vertical distance to the nearest source in the same column, for every tile.
+// Columns are handled in bands, a whole band row at a time.
+static void columnPass(std::span<const std::uint8_t> sources, int rows, int cols, std::pmr::vector<float>& out,
+                       int threads) {
+    const int bands = (cols + ColumnBand - 1) / ColumnBand;
+    parallelFor(bands, threads, [&](int band) {
+        const int begin = band * ColumnBand;
+        const int end = std::min(cols, begin + ColumnBand);
+        const float far = DistanceField::Infinity;
+
+        // Downwards: distance to the nearest source at or above
+        for (int c = begin; c < end; ++c) out[c] = sources[c] ? 0.f : far;
+        for (int r = 1; r < rows; ++r) {
+            const std::uint8_t* source = &sources[static_cast<std::size_t>(r) * cols];
+            const float* above = &out[static_cast<std::size_t>(r - 1) * cols];
+            float* here = &out[static_cast<std::size_t>(r) * cols];
+            for (int c = begin; c < end; ++c) here[c] = source[c] ? 0.f : above[c] + 1.f;
+        }
+        // Upwards: or below, if that is closer
+        for (int r = rows - 2; r >= 0; --r) {
+            const float* below = &out[static_cast<std::size_t>(r + 1) * cols];
+            float* here = &out[static_cast<std::size_t>(r) * cols];
+            for (int c = begin; c < end; ++c) here[c] = std::min(here[c], below[c] + 1.f);
+        }
+    });
+}
+
+// Exact Euclidean distance along one row: lower envelope of the
+// parabolas (x - q)^2 + g(q)^2 rooted at each column q
+static void euclideanRow(float* row, int cols, double* g2, int* roots, double* bounds) {
+    int count = 0;
+    for (int q = 0; q < cols; ++q) {
+        if (std::isinf(row[q])) continue;
+        g2[q] = static_cast<double>(row[q]) * row[q];
+        while (count > 0) {
+            int p = roots[count - 1];
+            // Where the new parabola starts beating the last one on the envelope
+            double s = ((g2[q] + double(q) * q) - (g2[p] + double(p) * p)) / (2.0 * (q - p));
+            if (s > bounds[count - 1]) {
+                roots[count] = q;
+                bounds[count] = s;
+                ++count;
+                break;
+            }
+            --count;
+        }
+        if (count == 0) {
+            roots[0] = q;
+            bounds[0] = -std::numeric_limits<double>::infinity();
+            count = 1;
+        }
+    }
+
+    if (count == 0) return; // no source anywhere in reach of this row
+    int k = 0;
+    for (int x = 0; x < cols; ++x) {
+        while (k + 1 < count && bounds[k + 1] < x) ++k;
+        double dx = x - roots[k];
+        row[x] = static_cast<float>(std::sqrt(dx * dx + g2[roots[k]]));
+    }
+}
+
+// Exact Manhattan distance along one row: forward then backward sweep
+static void manhattanRow(float* row, int cols) {
+    for (int x = 1; x < cols; ++x) row[x] = std::min(row[x], row[x - 1] + 1.f);
+    for (int x = cols - 2; x >= 0; --x) row[x] = std::min(row[x], row[x + 1] + 1.f);
+}
+
+// Two raster sweeps with a 3x3 mask: orthogonal steps cost `straight`, diagonal ones `diagonal`
+static void chamferPass(std::span<const std::uint8_t> sources, int rows, int cols, std::pmr::vector<float>& out,
+                        float straight, float diagonal) {
+    for (std::size_t i = 0; i < out.size(); ++i) out[i] = sources[i] ? 0.f : DistanceField::Infinity;
+
+    auto relax = [&](int r, int c, int dr, int dc, float cost) {
+        int nr = r + dr;
+        int nc = c + dc;
+        if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) return;
+        float& here = out[r * cols + c];
+        here = std::min(here, out[nr * cols + nc] + cost);
+    };
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            relax(r, c, -1, -1, diagonal);
+            relax(r, c, -1, 0, straight);
+            relax(r, c, -1, 1, diagonal);
+            relax(r, c, 0, -1, straight);
+        }
+    }
+    for (int r = rows - 1; r >= 0; --r) {
+        for (int c = cols - 1; c >= 0; --c) {
+            relax(r, c, 1, 1, diagonal);
+            relax(r, c, 1, 0, straight);
+            relax(r, c, 1, -1, diagonal);
+            relax(r, c, 0, 1, straight);
+        }
+    }
+}
+
+DistanceField distanceTransform(std::span<const std::uint8_t> sources, int rows, int cols, DistanceMetric metric,
+                                int threads, std::pmr::memory_resource* resource) {
+    PROFILE_SCOPE("distanceTransform");
+    DistanceField field{0, 0, std::pmr::vector<float>(resource)};
+    field.rows = rows;
+    field.cols = cols;
+    field.values.assign(static_cast<std::size_t>(rows) * cols, DistanceField::Infinity);
+    if (rows == 0 || cols == 0) return field;
+
+    if (metric == DistanceMetric::Chessboard) {
+        chamferPass(sources, rows, cols, field.values, 1.f, 1.f);
+        return field;
+    }
+    if (metric == DistanceMetric::Chamfer34) {
+        chamferPass(sources, rows, cols, field.values, 3.f, 4.f);
+        for (float& value : field.values) value /= 3.f;
+        return field;
+    }
+
+    columnPass(sources, rows, cols, field.values, threads);
+
+    const int bands = std::max(1, std::min(threads <= 0 ? 64 : threads, rows / 16));
+    const int bandRows = (rows + bands - 1) / bands;
+    // Envelope arrays for every band, taken up front so the bands don't allocate
+    const std::size_t envelope = metric == DistanceMetric::Euclidean ? static_cast<std::size_t>(bands) * cols : 0;
+    std::pmr::vector<double> g2(envelope, resource), bounds(envelope, resource);
+    std::pmr::vector<int> roots(envelope, resource);
+    parallelFor(bands, threads, [&](int band) {
+        const std::size_t offset = static_cast<std::size_t>(band) * cols;
+        for (int r = band * bandRows; r < std::min(rows, (band + 1) * bandRows); ++r) {
+            float* row = &field.values[static_cast<std::size_t>(r) * cols];
+            if (metric == DistanceMetric::Euclidean) {
+                euclideanRow(row, cols, &g2[offset], &roots[offset], &bounds[offset]);
+            } else {
+                manhattanRow(row, cols);
+            }
+        }
+    });
+    return field;
+}
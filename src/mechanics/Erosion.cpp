@@ -0,0 +1,208 @@
+#include "Erosion.hpp"
+#include "../Tools/ParallelFor.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+static const int RegionSize = 64;
+static const int RoundDroplets = 128; // per region per round
+static const int MaxRadius = 8;
+
+// Offsets and weights of the erosion brush, weights falling off linearly with
+// distance and summing to one
+struct Brush {
+    std::pmr::vector<int> rowOffsets, colOffsets;
+    std::pmr::vector<float> weights;
+};
+
+static Brush makeBrush(int radius, std::pmr::memory_resource* resource) {
+    Brush brush{std::pmr::vector<int>(resource), std::pmr::vector<int>(resource), std::pmr::vector<float>(resource)};
+    float total = 0.f;
+    for (int dr = -radius; dr <= radius; ++dr) {
+        for (int dc = -radius; dc <= radius; ++dc) {
+            const float weight = static_cast<float>(radius) - std::sqrt(static_cast<float>(dr * dr + dc * dc));
+            if (weight <= 0.f) continue;
+            brush.rowOffsets.push_back(dr);
+            brush.colOffsets.push_back(dc);
+            brush.weights.push_back(weight);
+            total += weight;
+        }
+    }
+    if (brush.weights.empty()) { // radius 0: just the tile under the droplet
+        brush.rowOffsets.push_back(0);
+        brush.colOffsets.push_back(0);
+        brush.weights.push_back(1.f);
+        total = 1.f;
+    }
+    for (float& weight : brush.weights) weight /= total;
+    return brush;
+}
+
+// Everything one region's droplets need; heights are shared between regions
+struct ErosionContext {
+    std::span<float> height;
+    std::span<const std::uint8_t> fixed;
+    int rows, cols;
+    const ErosionSettings& settings;
+    const Brush& brush;
+
+    bool isFixed(int index) const { return !fixed.empty() && fixed[index]; }
+
+    // Bilinear height and gradient at (x, y) = (col, row); needs x < cols - 1, y < rows - 1
+    float sample(float x, float y, float& gradX, float& gradY) const {
+        const int col = static_cast<int>(x), row = static_cast<int>(y);
+        const float u = x - static_cast<float>(col), v = y - static_cast<float>(row);
+        const int index = row * cols + col;
+        const float h00 = height[index], h10 = height[index + 1];
+        const float h01 = height[index + cols], h11 = height[index + cols + 1];
+        gradX = (h10 - h00) * (1.f - v) + (h11 - h01) * v;
+        gradY = (h01 - h00) * (1.f - u) + (h11 - h10) * u;
+        return h00 * (1.f - u) * (1.f - v) + h10 * u * (1.f - v) + h01 * (1.f - u) * v + h11 * u * v;
+    }
+
+    void deposit(float x, float y, float amount) {
+        const int col = static_cast<int>(x), row = static_cast<int>(y);
+        const float u = x - static_cast<float>(col), v = y - static_cast<float>(row);
+        const int index = row * cols + col;
+        const int corners[4] = {index, index + 1, index + cols, index + cols + 1};
+        const float shares[4] = {(1.f - u) * (1.f - v), u * (1.f - v), (1.f - u) * v, u * v};
+        for (int k = 0; k < 4; ++k) {
+            if (!isFixed(corners[k])) height[corners[k]] += amount * shares[k];
+        }
+    }
+
+    // Takes up to `amount` from the brush around the tile under the droplet; returns what it took
+    float erode(float x, float y, float amount) {
+        const int col = static_cast<int>(x), row = static_cast<int>(y);
+        float taken = 0.f;
+        for (std::size_t k = 0; k < brush.weights.size(); ++k) {
+            const int r = row + brush.rowOffsets[k], c = col + brush.colOffsets[k];
+            if (r < 0 || r >= rows || c < 0 || c >= cols) continue;
+            const int index = r * cols + c;
+            if (isFixed(index)) continue;
+            const float share = amount * brush.weights[k];
+            height[index] -= share;
+            taken += share;
+        }
+        return taken;
+    }
+
+    // One droplet from (x, y), kept inside [minX, maxX) x [minY, maxY)
+    void runDroplet(float x, float y, float minX, float maxX, float minY, float maxY) {
+        float dirX = 0.f, dirY = 0.f;
+        float speed = 1.f, water = 1.f, sediment = 0.f;
+
+        for (int step = 0; step < settings.maxSteps; ++step) {
+            float gradX, gradY;
+            const float here = sample(x, y, gradX, gradY);
+
+            // Turn towards the downhill direction, keeping some momentum
+            dirX = dirX * settings.inertia - gradX * (1.f - settings.inertia);
+            dirY = dirY * settings.inertia - gradY * (1.f - settings.inertia);
+            const float length = std::sqrt(dirX * dirX + dirY * dirY);
+            if (length < 1e-6f) break; // flat: nowhere to go
+            dirX /= length;
+            dirY /= length;
+
+            const float nextX = x + dirX, nextY = y + dirY;
+            if (nextX < minX || nextX >= maxX || nextY < minY || nextY >= maxY) break;
+            if (isFixed(static_cast<int>(nextY) * cols + static_cast<int>(nextX))) break; // reached an outlet
+
+            float ignoreX, ignoreY;
+            const float drop = sample(nextX, nextY, ignoreX, ignoreY) - here;
+            const float capacity = std::max(-drop, settings.minSlope) * speed * water * settings.capacity;
+
+            if (sediment > capacity || drop > 0.f) {
+                // Uphill: fill the pit behind it; otherwise shed what it can't carry
+                const float amount = drop > 0.f ? std::min(drop, sediment) : (sediment - capacity) * settings.depositRate;
+                sediment -= amount;
+                deposit(x, y, amount);
+            } else {
+                // Never dig deeper than the drop, or the droplet would cut a pit
+                const float amount = std::min((capacity - sediment) * settings.erodeRate, -drop);
+                sediment += erode(x, y, amount);
+            }
+
+            speed = std::sqrt(std::max(0.f, speed * speed - drop * settings.gravity));
+            water *= 1.f - settings.evaporation;
+            x = nextX;
+            y = nextY;
+        }
+    }
+};
+
+void erodeHeightfield(std::span<float> height, int rows, int cols, std::span<const std::uint8_t> fixed,
+                      unsigned int seed, const ErosionSettings& settings, int threads,
+                      std::pmr::memory_resource* resource, const std::atomic<bool>* cancel) {
+    PROFILE_SCOPE("erodeHeightfield");
+    if (rows < 2 || cols < 2) return;
+
+    const int radius = std::clamp(settings.radius, 0, MaxRadius);
+    const Brush brush = makeBrush(radius, resource);
+    ErosionContext context{height, fixed, rows, cols, settings, brush};
+
+    // How far a droplet may leave its region: regions of one colour are a region
+    // apart, and a droplet also reads one tile and erodes `radius` tiles past itself
+    const int margin = RegionSize / 2 - radius - 2;
+
+    const int regionRows = (rows + RegionSize - 1) / RegionSize;
+    const int regionCols = (cols + RegionSize - 1) / RegionSize;
+    const int regionCount = regionRows * regionCols;
+    const long long tiles = static_cast<long long>(rows) * cols;
+    const long long droplets = settings.droplets > 0 ? settings.droplets : tiles / 2;
+
+    // Each region's share of the budget follows its area; each has its own RNG
+    std::pmr::vector<long long> remaining(regionCount, resource);
+    std::pmr::vector<std::mt19937> rngs(resource);
+    rngs.reserve(regionCount);
+    long long rounds = 0;
+    for (int region = 0; region < regionCount; ++region) {
+        const int rowBegin = (region / regionCols) * RegionSize, colBegin = (region % regionCols) * RegionSize;
+        const long long area = static_cast<long long>(std::min(RegionSize, rows - rowBegin)) *
+                               std::min(RegionSize, cols - colBegin);
+        remaining[region] = droplets * area / tiles;
+        rounds = std::max(rounds, (remaining[region] + RoundDroplets - 1) / RoundDroplets);
+        std::seed_seq sequence{seed, static_cast<unsigned int>(region)};
+        rngs.emplace_back(sequence);
+    }
+
+    // Regions of each checkerboard colour
+    std::pmr::vector<int> phases[4] = {std::pmr::vector<int>(resource), std::pmr::vector<int>(resource),
+                                       std::pmr::vector<int>(resource), std::pmr::vector<int>(resource)};
+    for (int region = 0; region < regionCount; ++region) {
+        phases[(region / regionCols) % 2 * 2 + (region % regionCols) % 2].push_back(region);
+    }
+
+    for (long long round = 0; round < rounds; ++round) {
+        for (const std::pmr::vector<int>& phase : phases) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) return;
+            parallelFor(static_cast<int>(phase.size()), threads, [&](int i) {
+                const int region = phase[i];
+                const int rowBegin = (region / regionCols) * RegionSize, colBegin = (region % regionCols) * RegionSize;
+                const int rowEnd = std::min(rowBegin + RegionSize, rows), colEnd = std::min(colBegin + RegionSize, cols);
+
+                // Sampling reads the tile past the droplet, so stay a tile short of the far edges
+                const float minX = static_cast<float>(std::max(0, colBegin - margin));
+                const float maxX = static_cast<float>(std::min(cols - 1, colEnd + margin));
+                const float minY = static_cast<float>(std::max(0, rowBegin - margin));
+                const float maxY = static_cast<float>(std::min(rows - 1, rowEnd + margin));
+
+                std::mt19937& rng = rngs[region];
+                std::uniform_real_distribution<float> startX(static_cast<float>(colBegin),
+                                                             static_cast<float>(std::min(colEnd, cols - 1)));
+                std::uniform_real_distribution<float> startY(static_cast<float>(rowBegin),
+                                                             static_cast<float>(std::min(rowEnd, rows - 1)));
+                const long long count = std::min<long long>(RoundDroplets, remaining[region]);
+                for (long long d = 0; d < count; ++d) {
+                    const float x = startX(rng), y = startY(rng);
+                    if (x >= maxX || y >= maxY) continue; // float rounding at the upper bound
+                    if (context.isFixed(static_cast<int>(y) * cols + static_cast<int>(x))) continue;
+                    context.runDroplet(x, y, minX, maxX, minY, maxY);
+                }
+                remaining[region] -= count;
+            });
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+struct ErosionSettings {
+    int droplets = 0;          // budget for the whole map, 0 = one per two tiles
+    int maxSteps = 24;         // droplet lifetime, in moves of one tile
+    int radius = 2;            // erosion brush radius in tiles, at most 8
+    float inertia = 0.05f;     // share of the old direction kept each step
+    float capacity = 4.f;      // sediment carried per unit of slope, speed and water
+    float minSlope = 0.01f;    // keeps some capacity on flat ground
+    float erodeRate = 0.3f;    // share of the spare capacity taken from the ground per step
+    float depositRate = 0.3f;  // share of the excess sediment dropped per step
+    float evaporation = 0.02f; // share of the water lost per step
+    float gravity = 4.f;
+};
+
+// Particle hydraulic erosion of a row-major heightfield. Each droplet rolls
+// downhill with some inertia, picking sediment up while it speeds down slopes
+// and dropping it where it slows or climbs, which cuts connected valleys into
+// the field. Tiles flagged in `fixed` (may be empty) are outlets: a droplet
+// that reaches one is gone with its load, and their heights never change.
+//
+// The map is split into 64x64 regions and droplets start inside a region and
+// die if they wander more than about half a region out of it, so regions two
+// apart never touch the same tile. Work runs in rounds of four phases (one per
+// region colour of a 2x2 checkerboard), each phase's regions in parallel over
+// `threads` threads (0 = one per core). Every region has its own RNG, so the
+// result depends only on the seed and settings, not on the thread count.
+// Working arrays come from `resource`. Once `cancel` (may be null) is set the
+// remaining phases are skipped and the field is left part eroded.
+void erodeHeightfield(std::span<float> height, int rows, int cols, std::span<const std::uint8_t> fixed,
+                      unsigned int seed, const ErosionSettings& settings = {}, int threads = 0,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+                      const std::atomic<bool>* cancel = nullptr);
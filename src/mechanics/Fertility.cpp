@@ -1,4 +1,5 @@
 #include "Fertility.hpp"
+#include <algorithm>
 #include <iostream>
 #include <random>
 
@@ -6,12 +7,12 @@
 
 FertilityMap::FertilityMap(int rows, int cols) : rows(rows), cols(cols) {
     fertilityGrid.resize(rows, std::vector<float>(cols, 0.0f));
+    smoothed.resize(rows, std::vector<float>(cols, 0.0f));
 }
 
 
-void FertilityMap::generateFromTerrain(const std::vector<std::vector<int>>& terrainMap) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+void FertilityMap::generateFromTerrain(const std::vector<std::vector<int>>& terrainMap, unsigned int seed) {
+    std::mt19937 gen(seed);
 
     // Step 1: Populate fertilityGrid with randomized fertility
     for (int r = 0; r < rows; ++r) {
@@ -56,7 +57,6 @@ void FertilityMap::generateFromTerrain(const std::vector<std::vector<int>>& terr
     }
 
     // Step 2: Smooth fertility using a 3x3 box blur
-    std::vector<std::vector<float>> smoothed(rows, std::vector<float>(cols, 0.0f));
 
     for (int r = 0; r < rows; ++r) {
         for (int c = 0; c < cols; ++c) {
@@ -79,7 +79,7 @@ void FertilityMap::generateFromTerrain(const std::vector<std::vector<int>>& terr
         }
     }
 
-    fertilityGrid = smoothed;
+    fertilityGrid.swap(smoothed);
 }
 
 
@@ -89,57 +89,3 @@ void FertilityMap::generateFromTerrain(const std::vector<std::vector<int>>& terr
 const std::vector<std::vector<float>>& FertilityMap::getFertilityGrid() const {
     return fertilityGrid;
 }
-
-
-sf::VertexArray FertilityMap::createFertilityOverlay(float cellSize) const {
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles);
-    vertices.resize(rows * cols * 6);
-
-    // We'll map fertility (0.0 to 1.0) to color from brown (low) to green (high)
-    auto fertilityToColor = [](float fert) -> sf::Color {
-        // clamp fert to [0,10]
-        fert = std::clamp(fert, 0.0f, 5.0f);
-        // Interpolate between brown (128, 64, 0) and green (0, 255, 0)
-        int r = static_cast<int>(128 * (1.0f - fert));
-        int g = static_cast<int>(64 + (255 - 64) * fert);
-        int b = 0;
-        return sf::Color(r, g, b, 100);  // semi-transparent alpha
-    };
-
-    // If fertility grid stores ints (0-100), normalize to 0-1 first:
-    // float fertNorm = fertilityValue / 100.0f;
-
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            float x = col * cellSize;
-            float y = row * cellSize;
-
-            float fertValue = fertilityGrid[row][col]; // your fertility value here, float 0-1 or int normalized
-            float fertNorm = fertValue / 1.0f;       // normalize if fertilityGrid is 0-100
-
-            sf::Color color = fertilityToColor(fertNorm);
-
-            int i = (row * cols + col) * 6;
-
-            vertices[i + 0].position = sf::Vector2f(x, y);
-            vertices[i + 0].color = color;
-
-            vertices[i + 1].position = sf::Vector2f(x + cellSize, y);
-            vertices[i + 1].color = color;
-
-            vertices[i + 2].position = sf::Vector2f(x, y + cellSize);
-            vertices[i + 2].color = color;
-
-            vertices[i + 3].position = sf::Vector2f(x, y + cellSize);
-            vertices[i + 3].color = color;
-
-            vertices[i + 4].position = sf::Vector2f(x + cellSize, y);
-            vertices[i + 4].color = color;
-
-            vertices[i + 5].position = sf::Vector2f(x + cellSize, y + cellSize);
-            vertices[i + 5].color = color;
-        }
-    }
-
-    return vertices;
-}
@@ -1,17 +1,17 @@
 #pragma once
 
-#include "MapGenerator.hpp"
 #include <vector>
+#include <random>
 
 class FertilityMap {
 public:
     FertilityMap(int rows, int cols);
 
-    void generateFromTerrain(const std::vector<std::vector<int>>& terrainMap);
+    void generateFromTerrain(const std::vector<std::vector<int>>& terrainMap, unsigned int seed = std::random_device{}());
     const std::vector<std::vector<float>>& getFertilityGrid() const;
-    sf::VertexArray createFertilityOverlay(float cellSize) const;
 
 private:
     int rows, cols;
     std::vector<std::vector<float>> fertilityGrid;
+    std::vector<std::vector<float>> smoothed; // blur target, swapped with fertilityGrid; kept so a reused map doesn't allocate
 };
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <vector>
-#include <SFML/Graphics.hpp>
 
 class FogOfWarMap {
 public:
@@ -14,11 +13,17 @@ public:
     // Set a specific tile to visible (2)
     void reveal(int row, int col);
 
+    // Set every tile within radius of the centre to visible (2)
+    void revealRadius(int centerRow, int centerCol, int radius);
+
     // Downgrade all currently visible tiles (2) to seen (1)
     void markSeen();
+    // Same, but only inside the square around a centre; enough when everything
+    // visible came from one revealRadius call with that centre and radius
+    void markSeenRadius(int centerRow, int centerCol, int radius);
 
-    // Create a fog overlay to render based on the fogGrid values
-    sf::VertexArray createFogOverlay(float cellSize) const;
+    int getRows() const;
+    int getCols() const;
 
     // Access the fog grid for read/write (non-const)
     std::vector<std::vector<int>>& getFogGrid();
@@ -0,0 +1,216 @@
+#include "GenerationPipeline.hpp"
+#include "../Tools/AllocationCounter.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <set>
+
+// FNV-1a, used to give every stage its own RNG stream
+static unsigned int hashName(const std::string& name) {
+    unsigned int hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool conflicts(const GenerationStage& a, const GenerationStage& b) {
+    return (a.writes & (b.reads | b.writes)) || (b.writes & a.reads);
+}
+
+void GenerationPipeline::addStage(GenerationStage stage) {
+    order.push_back(static_cast<int>(stages.size()));
+    stages.push_back(std::move(stage));
+}
+
+bool GenerationPipeline::loadConfig(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Generation config " << path << " not found\n";
+        return false;
+    }
+
+    std::vector<std::string> names;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty()) names.push_back(line);
+    }
+    return setOrder(names);
+}
+
+bool GenerationPipeline::setOrder(const std::vector<std::string>& names) {
+    std::vector<int> newOrder;
+    std::set<std::string> seen;
+    unsigned int available = LayerTerrain;
+
+    for (const auto& name : names) {
+        auto it = std::find_if(stages.begin(), stages.end(),
+                               [&](const GenerationStage& s) { return s.name == name; });
+        if (it == stages.end()) {
+            std::cerr << "Unknown generation stage '" << name << "'\n";
+            return false;
+        }
+        if (!seen.insert(name).second) {
+            std::cerr << "Generation stage '" << name << "' listed twice\n";
+            return false;
+        }
+        unsigned int missing = it->reads & DerivedLayers & ~available;
+        if (missing) {
+            std::cerr << "Generation stage '" << name << "' reads a layer no earlier stage writes\n";
+            return false;
+        }
+        available |= it->writes;
+        newOrder.push_back(static_cast<int>(it - stages.begin()));
+    }
+
+    order = newOrder;
+    return true;
+}
+
+std::vector<std::string> GenerationPipeline::getOrder() const {
+    std::vector<std::string> names;
+    for (int index : order) names.push_back(stages[index].name);
+    return names;
+}
+
+int GenerationPipeline::getEnabledCount() const {
+    return static_cast<int>(order.size());
+}
+
+void GenerationPipeline::setParallel(bool enabled) {
+    parallel = enabled;
+}
+
+bool GenerationPipeline::isParallel() const {
+    return parallel;
+}
+
+// Wave number for each entry of order: one past the latest conflicting earlier stage
+std::vector<int> GenerationPipeline::computeWaves() const {
+    std::vector<int> waves(order.size(), 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (conflicts(stages[order[i]], stages[order[j]])) {
+                waves[i] = std::max(waves[i], waves[j] + 1);
+            }
+        }
+    }
+    return waves;
+}
+
+bool GenerationPipeline::run(unsigned int seed, const ProgressCallback& onStage) {
+    timings.clear();
+    const std::vector<int> waves = computeWaves();
+    const int waveCount = waves.empty() ? 0 : *std::max_element(waves.begin(), waves.end()) + 1;
+    const int stageCount = getEnabledCount();
+
+    for (int wave = 0; wave < waveCount; ++wave) {
+        const int width = static_cast<int>(std::count(waves.begin(), waves.end(), wave));
+        while (static_cast<int>(arenas.size()) < width) arenas.push_back(std::make_unique<ScratchArena>());
+    }
+
+    auto runStage = [&](int position, ScratchArena& scratch) {
+        const GenerationStage& stage = stages[order[position]];
+        std::seed_seq seq{seed, hashName(stage.name)};
+        std::mt19937 rng(seq);
+
+        AllocationStats before = threadAllocationStats();
+        auto start = std::chrono::steady_clock::now();
+        {
+            ProfileScope scope(Profiler::intern(stage.name));
+            stage.run(rng, scratch);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        AllocationStats after = threadAllocationStats();
+        const long long scratchBytes = static_cast<long long>(scratch.bytesInUse());
+        scratch.reset();
+
+        return StageTiming{stage.name, waves[position], elapsed.count(),
+                           after.count - before.count, after.bytes - before.bytes, scratchBytes};
+    };
+
+    for (int wave = 0; wave < waveCount; ++wave) {
+        std::vector<int> members;
+        for (int i = 0; i < stageCount; ++i) {
+            if (waves[i] == wave) members.push_back(i);
+        }
+
+        // Every member but the first gets its own thread; the first runs here
+        std::vector<std::future<StageTiming>> pending;
+        if (parallel) {
+            for (size_t m = 1; m < members.size(); ++m) {
+                pending.push_back(std::async(std::launch::async, runStage, members[m], std::ref(*arenas[m])));
+            }
+        }
+
+        std::vector<StageTiming> finished;
+        finished.push_back(runStage(members[0], *arenas[0]));
+        if (parallel) {
+            for (auto& future : pending) finished.push_back(future.get());
+        } else {
+            for (size_t m = 1; m < members.size(); ++m) finished.push_back(runStage(members[m], *arenas[m]));
+        }
+
+        for (const StageTiming& timing : finished) {
+            timings.push_back(timing);
+            int index = static_cast<int>(timings.size()) - 1;
+            if (onStage && !onStage({index, stageCount, timings.back().name.c_str(),
+                                     timing.millis, timing.allocations})) {
+                return false; // Cancelled
+            }
+        }
+    }
+    return true;
+}
+
+const std::vector<StageTiming>& GenerationPipeline::getTimings() const {
+    return timings;
+}
+
+void GenerationPipeline::printTimings(std::ostream& out) const {
+    double total = 0.0;
+    for (const auto& t : timings) total += t.millis;
+
+    std::vector<StageTiming> sorted = timings;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const StageTiming& a, const StageTiming& b) { return a.millis > b.millis; });
+
+    out << std::left << std::setw(28) << "stage" << std::right
+        << std::setw(6) << "wave" << std::setw(11) << "ms" << std::setw(8) << "%"
+        << std::setw(10) << "allocs" << std::setw(12) << "KiB" << std::setw(14) << "scratch KiB" << "\n";
+    // Without the counting allocator the heap columns would read a misleading 0
+    const bool counted = allocationCountingEnabled();
+    for (const auto& t : sorted) {
+        out << std::left << std::setw(28) << t.name << std::right
+            << std::setw(6) << t.wave
+            << std::setw(11) << std::fixed << std::setprecision(2) << t.millis
+            << std::setw(8) << std::setprecision(1) << (total > 0.0 ? 100.0 * t.millis / total : 0.0);
+        if (counted) out << std::setw(10) << t.allocations << std::setw(12) << t.allocatedBytes / 1024;
+        else out << std::setw(10) << "-" << std::setw(12) << "-";
+        out << std::setw(14) << t.scratchBytes / 1024 << "\n";
+    }
+    out << std::left << std::setw(28) << "total (sum of stages)" << std::right << std::setw(17)
+        << std::setprecision(2) << total << "\n";
+
+#ifndef NDEBUG
+    // The arenas only count in debug builds; totals since the pipeline was made
+    ScratchArena::Stats scratch;
+    for (const auto& arena : arenas) {
+        const ScratchArena::Stats stats = arena->getStats();
+        scratch.allocations += stats.allocations;
+        scratch.bytes += stats.bytes;
+        scratch.blocks += stats.blocks;
+    }
+    out << "scratch arenas: " << arenas.size() << ", " << scratch.allocations << " allocations ("
+        << scratch.bytes / 1024 << " KiB), " << scratch.blocks << " blocks from the heap\n";
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../Tools/ScratchArena.hpp"
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Map data a generation stage can read or write. Stages whose accesses don't
+// overlap have no ordering between them and may run at the same time.
+enum MapLayer : unsigned int {
+    LayerLandCover  = 1u << 0,                          // tile types of land tiles
+    LayerWaterCover = 1u << 1,                          // tile types of sea-side tiles
+    LayerTerrain    = LayerLandCover | LayerWaterCover, // every tile type
+    LayerWaterMask  = 1u << 2,                          // which tiles are sea-side
+    LayerHeight     = 1u << 3,                          // height map used by rivers
+    LayerClimate    = 1u << 4,                          // temperature and moisture fields
+};
+
+// Layers that don't exist until a stage produces them
+constexpr unsigned int DerivedLayers = LayerWaterMask | LayerHeight | LayerClimate;
+
+// A stage's temporaries go in `scratch`, which is emptied when the stage returns
+struct GenerationStage {
+    std::string name;
+    unsigned int reads;
+    unsigned int writes;
+    std::function<void(std::mt19937& rng, ScratchArena& scratch)> run;
+};
+
+// Reported after each generation stage finishes
+struct GenerationProgress {
+    int stageIndex;
+    int stageCount;
+    const char* stageName;
+    double stageMillis;
+    long long allocations;
+};
+
+// Return false to cancel the remaining stages
+using ProgressCallback = std::function<bool(const GenerationProgress&)>;
+
+struct StageTiming {
+    std::string name;
+    int wave;                 // stages in the same wave ran concurrently
+    double millis;
+    long long allocations;    // from the heap, on the stage's thread; 0 unless GRIDGAME_COUNT_ALLOCATIONS
+    long long allocatedBytes;
+    long long scratchBytes;   // taken from the stage's scratch arena
+};
+
+// Runs generation stages as a dependency graph. A stage depends on every earlier
+// stage (in the configured order) whose layer accesses conflict with its own;
+// stages with no path between them are grouped into a wave and run concurrently.
+class GenerationPipeline {
+public:
+    // Registers a stage; stages run in registration order until setOrder/loadConfig
+    void addStage(GenerationStage stage);
+
+    // One stage name per line, '#' starts a comment. Registered stages that are not
+    // listed are skipped. On error, prints why and keeps the current order.
+    bool loadConfig(const std::string& path);
+    bool setOrder(const std::vector<std::string>& names);
+    std::vector<std::string> getOrder() const;
+    int getEnabledCount() const;
+
+    // With parallel off every stage runs on the calling thread in order, and stages
+    // that split their own work over threads should keep to one (see isParallel)
+    void setParallel(bool enabled);
+    bool isParallel() const;
+
+    // Each stage gets its own RNG stream derived from the seed and its name, so the
+    // result doesn't depend on scheduling. Stages running side by side get
+    // separate scratch arenas; the arenas are kept from run to run, so a
+    // pipeline that is run again reuses their memory. Returns false if the
+    // callback cancelled.
+    bool run(unsigned int seed, const ProgressCallback& onStage = {});
+
+    const std::vector<StageTiming>& getTimings() const;
+    void printTimings(std::ostream& out) const;
+
+private:
+    std::vector<GenerationStage> stages;
+    std::vector<int> order;   // indices into stages
+    std::vector<StageTiming> timings;
+    std::vector<std::unique_ptr<ScratchArena>> arenas; // one per stage in the widest wave
+    bool parallel = true;
+
+    std::vector<int> computeWaves() const;
+};
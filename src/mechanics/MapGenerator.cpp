@@ -1,68 +1,150 @@
 #include "MapGenerator.hpp"
+#include "Components.hpp"
+#include "DistanceField.hpp"
+#include "Noise.hpp"
+#include "Climate.hpp"
+#include "Zoom.hpp"
+#include <array>
+#include <bit>
 #include <cstdlib>
 #include <queue>
 #include <vector>
 #include <utility> // For std::pair
-#include <ctime>   // For std::srand, std::rand
 #include <algorithm> // For std::shuffle
 #include <random>    // For std::default_random_engine
 #include <cmath>
-#include <ctime>   // For time()
 #include <set>
 #include <limits> // For std::numeric_limits
 #include <iostream>
-#include <stack> // Add this include at the top of your file
-#include <SFML/Graphics.hpp> // Ensure SFML is included
 
-MapGenerator::MapGenerator(int rows, int cols)
-    : rows(rows), cols(cols), map(rows, std::vector<int>(cols, 0)) {
-    std::srand(std::time(nullptr)); // Seed the random number generator
+MapGenerator::MapGenerator(int rows, int cols, unsigned int seed)
+    : rows(rows), cols(cols), map(rows, std::vector<int>(cols, 0)), seed(seed) {
+    registerStages();
+}
+
+void MapGenerator::setSeed(unsigned int newSeed) {
+    seed = newSeed;
+}
+
+unsigned int MapGenerator::getSeed() const {
+    return seed;
+}
+
+// Uniform integer in [0, n)
+static int randomInt(std::mt19937& rng, int n) {
+    return std::uniform_int_distribution<int>(0, n - 1)(rng);
+}
+
+// Uniform double in [0, 1)
+static double randomUnit(std::mt19937& rng) {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+}
+
+// A stage's working copy of a tile grid, in its scratch arena
+using ScratchGrid = std::pmr::vector<std::pmr::vector<int>>;
+
+static ScratchGrid scratchCopy(const std::vector<std::vector<int>>& grid, ScratchArena& scratch) {
+    ScratchGrid copy(&scratch);
+    copy.reserve(grid.size());
+    for (const std::vector<int>& line : grid) copy.emplace_back(line.begin(), line.end());
+    return copy;
+}
+
+static void copyInto(const ScratchGrid& from, std::vector<std::vector<int>>& to) {
+    for (std::size_t row = 0; row < from.size(); ++row) std::copy(from[row].begin(), from[row].end(), to[row].begin());
 }
 
 const std::vector<std::vector<int>>& MapGenerator::getMap() const {
     return map;
 }
 
-// MASTER FUNCTION //
-void MapGenerator::generateMap() {
+const ClimateField& MapGenerator::getClimate() const {
+    return climate;
+}
 
-    initializeMap();
+// MASTER FUNCTION //
+bool MapGenerator::generateMap(const ProgressCallback& onStage) {
+    if (!cancelFlag) return pipeline.run(seed, onStage);
+    return pipeline.run(seed, [&](const GenerationProgress& progress) {
+        const bool keepGoing = !onStage || onStage(progress);
+        return keepGoing && !stopRequested();
+    });
+}
 
-    fillUnassignedWithSea();
-    applyModifiers();
+void MapGenerator::setCancelFlag(const std::atomic<bool>* flag) {
+    cancelFlag = flag;
+}
 
-    // Randomisation and smoothing
-    blendMap();
-    smoothMap();
+bool MapGenerator::stopRequested() const {
+    return cancelFlag && cancelFlag->load(std::memory_order_relaxed);
+}
 
-    ForceTundra();
-    // ForceDesert();
+// Threads for a stage's own parallel loops: all cores, or just the calling one when
+// the pipeline is serial (as when a caller runs several generators side by side)
+int MapGenerator::stageThreads() const {
+    return pipeline.isParallel() ? 0 : 1;
+}
 
-    changeSmallSeasToRivers(map);
-    MountainPeaks();
+int MapGenerator::getStageCount() const {
+    return pipeline.getEnabledCount();
+}
 
-    std::vector<std::vector<int>> heightMap = generateHeightMap();
+void MapGenerator::setErosionSettings(const ErosionSettings& settings) {
+    erosionSettings = settings;
+}
 
-    resetHeightMapToZero(heightMap,map);
+void MapGenerator::setLayoutScale(int scale) {
+    layoutScale = static_cast<int>(std::bit_floor(static_cast<unsigned int>(std::clamp(scale, 1, 16))));
+}
 
-    int seaLevel = 0;
+bool MapGenerator::loadStageConfig(const std::string& path) {
+    return pipeline.loadConfig(path);
+}
 
-    // // Check if the heightMap is valid before printing its size
-    // if (!heightMap.empty() && !heightMap[0].empty()) {
-    //     std::cout << "HeightMap size: " << heightMap.size() << " x " << heightMap[0].size() << std::endl;
-    // } else {
-    //     std::cerr << "Error: heightMap is empty or improperly initialized!" << std::endl;
-    // }
-    // std::cout << "Map size: " << map.size() << " x " << map[0].size() << std::endl;
-    // std::cout << "HeightMap size: " << heightMap.size() << " x " << heightMap[0].size() << std::endl;
+GenerationPipeline& MapGenerator::getPipeline() {
+    return pipeline;
+}
 
-    flowRivers(heightMap, map);
-    changeDesertToFloodplains(map);
-    applyForestChance(map);
-    convertToTaiga(map);
-    applyJungleChance(map);
-    applyCoastChance(map);
-    applyDeepOceanChance(map);
+// Every stage with the layers it touches. The finishing passes split into a land
+// chain and a water chain (see classifyWater) which the pipeline runs side by side.
+void MapGenerator::registerStages() {
+    const unsigned int terrain = LayerTerrain;
+    const unsigned int land = LayerWaterMask | LayerLandCover;
+    const unsigned int water = LayerWaterMask | LayerWaterCover;
+
+    pipeline.addStage({"initializeMap",             terrain, terrain, [this](std::mt19937& rng, ScratchArena& scratch) { initializeMap(rng, scratch); }});
+    pipeline.addStage({"noiseTerrain",              terrain, terrain, [this](std::mt19937& rng, ScratchArena& scratch) { noiseTerrain(rng, scratch); }});
+    pipeline.addStage({"coarseLayout",              terrain, terrain, [this](std::mt19937& rng, ScratchArena& scratch) { coarseLayout(rng, scratch); }});
+    pipeline.addStage({"fillUnassignedWithSea",     terrain, terrain, [this](std::mt19937&, ScratchArena&) { fillUnassignedWithSea(); }});
+    pipeline.addStage({"applyModifiers",            terrain, terrain, [this](std::mt19937& rng, ScratchArena&) { applyModifiers(rng); }});
+    // Randomisation and smoothing
+    pipeline.addStage({"blendMap",                  terrain, terrain, [this](std::mt19937& rng, ScratchArena& scratch) { blendMap(rng, scratch); }});
+    pipeline.addStage({"smoothMap",                 terrain, terrain, [this](std::mt19937&, ScratchArena& scratch) { smoothMap(scratch); }});
+    pipeline.addStage({"changeSmallSeasToRivers",   terrain, terrain, [this](std::mt19937&, ScratchArena& scratch) { changeSmallSeasToRivers(map, scratch); }});
+    pipeline.addStage({"MountainPeaks",             terrain, terrain, [this](std::mt19937& rng, ScratchArena& scratch) { MountainPeaks(rng, scratch); }});
+    pipeline.addStage({"generateHeightMap",         terrain, terrain | LayerHeight, [this](std::mt19937& rng, ScratchArena& scratch) {
+        generateHeightMap(rng, scratch);
+        resetHeightMapToZero(heightMap, map);
+    }});
+    pipeline.addStage({"erodeHeightMap",            terrain | LayerHeight, LayerHeight, [this](std::mt19937& rng, ScratchArena& scratch) { erodeHeightMap(rng, scratch); }});
+    pipeline.addStage({"flowRivers",                terrain | LayerHeight, terrain | LayerHeight, [this](std::mt19937&, ScratchArena& scratch) { flowRivers(heightMap, map, scratch); }});
+    pipeline.addStage({"computeClimate",            terrain | LayerHeight, LayerClimate, [this](std::mt19937&, ScratchArena& scratch) {
+        climate = computeClimate(map, climateHeight(scratch), stageThreads(), &scratch); // copied into climate's own storage
+    }});
+    pipeline.addStage({"assignBiomes",              terrain | LayerClimate, terrain, [this](std::mt19937& rng, ScratchArena&) { assignBiomes(rng); }});
+    pipeline.addStage({"classifyWater",             terrain, LayerWaterMask, [this](std::mt19937&, ScratchArena& scratch) { classifyWater(scratch); }});
+    pipeline.addStage({"changeDesertToFloodplains", land, LayerLandCover, [this](std::mt19937&, ScratchArena& scratch) { changeDesertToFloodplains(map, scratch); }});
+    pipeline.addStage({"applyCoastChance",          water, LayerWaterCover, [this](std::mt19937& rng, ScratchArena& scratch) { applyCoastChance(map, rng, scratch); }});
+    pipeline.addStage({"applyDeepOceanChance",      water, LayerWaterCover, [this](std::mt19937& rng, ScratchArena&) { applyDeepOceanChance(map, rng); }});
+
+    // Default order; resources/pipeline.cfg can override it
+    pipeline.setOrder({
+        "initializeMap", "fillUnassignedWithSea", "applyModifiers",
+        "blendMap", "smoothMap",
+        "changeSmallSeasToRivers", "MountainPeaks", "generateHeightMap", "flowRivers",
+        "computeClimate", "assignBiomes",
+        "classifyWater", "changeDesertToFloodplains", "applyCoastChance", "applyDeepOceanChance",
+    });
 }
 
 
@@ -71,10 +153,63 @@ float calculateDistance(int row1, int col1, int row2, int col2) {
     return std::sqrt((row1 - row2) * (row1 - row2) + (col1 - col2) * (col1 - col2));
 }
 
-void MapGenerator::initializeMap() {
-    // Seed the random number generator
-    std::srand(std::time(0));
+static constexpr float NoiseSeaFraction = 0.5f; // noiseTerrain's sea level, as a share of the field
+
+// Continuous terrain mode (resources/pipeline_noise.cfg): a domain-warped noise
+// heightfield cut at fixed fractions of the map into sea, land, hills and
+// mountains. Stands in for initializeMap through smoothMap; the biome passes
+// after it are the same as for the classic terrain.
+void MapGenerator::noiseTerrain(std::mt19937& rng, ScratchArena& scratch) {
+    // Feature sizes follow the map, as the classic biome count does
+    const float span = static_cast<float>(std::max(rows, cols));
+    NoiseSettings settings;
+    settings.frequency = 3.f / span;
+    settings.warpFrequency = 1.5f / span;
+    settings.warpStrength = span / 16.f;
+    elevation.resize(static_cast<std::size_t>(rows) * cols);
+    generateHeightfield(elevation, rows, cols, rng(), settings, stageThreads(), cancelFlag);
+    if (stopRequested()) return; // the map is thrown away
+
+    // Half the map is sea, then land, hills (9%) and mountains (7%)
+    static constexpr float fractions[] = {NoiseSeaFraction, 0.84f, 0.93f};
+    const std::pmr::vector<float> cuts = heightQuantiles(elevation, fractions, &scratch);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            const float height = elevation[static_cast<std::size_t>(row) * cols + col];
+            map[row][col] = height < cuts[0] ? 0 : height < cuts[1] ? 1 : height < cuts[2] ? 2 : 3;
+        }
+    }
+}
 
+// Coarse-to-fine mode (resources/pipeline_coarse.cfg): the biome flood fill,
+// blending and smoothing run on a map layoutScale times smaller each way, and
+// the result is zoomed back up to full size a doubling at a time. Stands in
+// for initializeMap through smoothMap; everything after runs at full size.
+void MapGenerator::coarseLayout(std::mt19937& rng, ScratchArena& scratch) {
+    elevation.clear(); // no heightfield in this mode; keeps the storage for a noise map
+    const int levels = std::countr_zero(static_cast<unsigned int>(layoutScale));
+    const int fineRows = rows, fineCols = cols;
+
+    // The layout passes work on map, rows and cols, so swap in the small map while they run
+    std::swap(map, layoutMap);
+    rows = (fineRows + layoutScale - 1) / layoutScale;
+    cols = (fineCols + layoutScale - 1) / layoutScale;
+    map.resize(rows);
+    for (std::vector<int>& line : map) line.assign(cols, -1);
+    initializeMap(rng, scratch);
+    fillUnassignedWithSea();
+    blendMap(rng, scratch);
+    // smoothMap's six passes reach about six tiles; keep that reach in full-size tiles
+    smoothMap(scratch, std::max(1, (6 + layoutScale - 1) / layoutScale));
+
+    std::swap(map, layoutMap);
+    rows = fineRows;
+    cols = fineCols;
+    upsampleTiles(layoutMap, levels, map, rng, &scratch);
+}
+
+void MapGenerator::initializeMap(std::mt19937& rng, ScratchArena& scratch) {
+    elevation.clear(); // no heightfield in this mode; keeps the storage for a noise map
     // Initialize map as unassigned (-1)
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
@@ -83,13 +218,14 @@ void MapGenerator::initializeMap() {
     }
 
     int numBiomes = 60; // Number of biomes
-    std::vector<int> biomeSeeds; // To store starting points of biomes
-    std::vector<std::pair<int, int>> biomeSeedPositions; // To store the actual (row, col) positions of biome seeds
+    std::pmr::vector<int> biomeSeeds(&scratch); // To store starting points of biomes
+    std::pmr::vector<std::pair<int, int>> biomeSeedPositions(&scratch); // To store the actual (row, col) positions of biome seeds
+    std::pmr::vector<std::pair<int, int>> biomeQueue(&scratch); // Flood fill queue, reused for every biome
 
     // Step 1: Place initial seeds for biomes
     for (int i = 0; i < numBiomes; ++i) {
-        int seedRow = std::rand() % rows;
-        int seedCol = std::rand() % cols;
+        int seedRow = randomInt(rng, rows);
+        int seedCol = randomInt(rng, cols);
         biomeSeeds.push_back(seedRow * cols + seedCol); // Store seed as a single index
         biomeSeedPositions.push_back({seedRow, seedCol}); // Store seed as (row, col)
         map[seedRow][seedCol] = i; // Mark seed with biome ID
@@ -97,25 +233,23 @@ void MapGenerator::initializeMap() {
 
     // Step 2: Grow biomes using randomized flood fill
     for (int biomeID = 0; biomeID < numBiomes; ++biomeID) {
+        if (stopRequested()) return; // the map is thrown away
         int maxSize = (rows * cols) / 35; // Approximate size of each biome
         int currentSize = 1;
 
-        std::queue<std::pair<int, int>> biomeQueue; // Queue for flood fill
+        biomeQueue.clear();
+        std::size_t queueHead = 0;
         int seedRow = biomeSeedPositions[biomeID].first;
         int seedCol = biomeSeedPositions[biomeID].second;
-        biomeQueue.push({seedRow, seedCol});
+        biomeQueue.push_back({seedRow, seedCol});
 
-        while (!biomeQueue.empty() && currentSize < maxSize) {
-            auto [row, col] = biomeQueue.front();
-            biomeQueue.pop();
+        while (queueHead < biomeQueue.size() && currentSize < maxSize) {
+            auto [row, col] = biomeQueue[queueHead++];
 
             // Define 4 cardinal directions (up, down, left, right)
-            std::vector<std::pair<int, int>> directions = {
-                {row - 1, col}, {row + 1, col}, {row, col - 1}, {row, col + 1}};
+            std::array<std::pair<int, int>, 4> directions = {{
+                {row - 1, col}, {row + 1, col}, {row, col - 1}, {row, col + 1}}};
 
-            // Use a random number generator for shuffling
-            std::random_device rd;
-            std::default_random_engine rng(rd());
             std::shuffle(directions.begin(), directions.end(), rng); // Shuffle directions
 
             for (const auto& dir : directions) {
@@ -144,7 +278,7 @@ void MapGenerator::initializeMap() {
                     }
 
                     map[newRow][newCol] = closestBiome; // Assign the tile to the closest biome
-                    biomeQueue.push({newRow, newCol});
+                    biomeQueue.push_back({newRow, newCol});
                     ++currentSize;
 
                     // Stop growing this biome if max size is reached
@@ -158,21 +292,21 @@ void MapGenerator::initializeMap() {
 
     // Step 3: Assign biome types using landBiome or seaBiome
     for (int biomeID = 0; biomeID < numBiomes; ++biomeID) {
-        int biome = std::rand() % 100; // Random value to decide the biome types
+        int biome = randomInt(rng, 100); // Random value to decide the biome types
         // int biome = 90; // For now fix whole map to a set biome
 
         // Assign biomes based on random chance, ensuring each biome gets only one type
         if (biome < 40) {
-            seaBiome(biomeID); // Call sea biome generation for 0-29
+            seaBiome(biomeID, rng); // Call sea biome generation for 0-29
         } 
         else if (biome < 70) {
-            landBiome(biomeID); // Call land biome generation for 30-59
+            landBiome(biomeID, rng); // Call land biome generation for 30-59
         } 
         else if (biome < 82) {
-            hillBiome(biomeID); // Call hill biome generation for 60-79
+            hillBiome(biomeID, rng); // Call hill biome generation for 60-79
         } 
         else {
-            mountainBiome(biomeID); // Call mountain biome generation for 80-99
+            mountainBiome(biomeID, rng); // Call mountain biome generation for 80-99
         }
     }
 }
@@ -181,15 +315,12 @@ void MapGenerator::initializeMap() {
 
 
 // Sea biome generation function (fills biome with sea, i.e., 0)
-void MapGenerator::seaBiome(int biomeID) {
-    // Seed the random number generator (if not already done in other parts of your code)
-    std::srand(std::time(0));
-
+void MapGenerator::seaBiome(int biomeID, std::mt19937& rng) {
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
             if (map[row][col] == biomeID) {
                 // Generate a random number between 0 and 99 to determine the biome type
-                int randVal = std::rand() % 100; // Random number between 0 and 99
+                int randVal = randomInt(rng, 100); // Random number between 0 and 99
 
                 if (randVal < 60) {
                     map[row][col] = 0; // 80% chance: Sea
@@ -208,15 +339,12 @@ void MapGenerator::seaBiome(int biomeID) {
 
 
 // Land biome generation function (fills biome with land, sea, or hills)
-void MapGenerator::landBiome(int biomeID) {
-    // Seed the random number generator (if not already done in other parts of your code)
-    std::srand(std::time(0));
-
+void MapGenerator::landBiome(int biomeID, std::mt19937& rng) {
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
             if (map[row][col] == biomeID) {
                 // Generate a random number between 0 and 99 to determine the biome type
-                int randVal = std::rand() % 100; // Random number between 0 and 99
+                int randVal = randomInt(rng, 100); // Random number between 0 and 99
 
                 if (randVal < 40) {
                     map[row][col] = 1; // 80% chance: Land
@@ -232,15 +360,12 @@ void MapGenerator::landBiome(int biomeID) {
 
 
 // Hill biome generation function (fills biome with hill, i.e., 2)
-void MapGenerator::hillBiome(int biomeID) {
-    // Seed the random number generator (if not already done in other parts of your code)
-    std::srand(std::time(0));
-
+void MapGenerator::hillBiome(int biomeID, std::mt19937& rng) {
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
             if (map[row][col] == biomeID) {
                 // Generate a random number between 0 and 99 to determine the biome type
-                int randVal = std::rand() % 100; // Random number between 0 and 99
+                int randVal = randomInt(rng, 100); // Random number between 0 and 99
 
                 if (randVal < 50) {
                     map[row][col] = 2; // 80% chance: Hills
@@ -258,15 +383,12 @@ void MapGenerator::hillBiome(int biomeID) {
 }
 
 // Mountain biome generation function (fills biome with mountain, i.e., 0)
-void MapGenerator::mountainBiome(int biomeID) {
-    // Seed the random number generator (if not already done in other parts of your code)
-    std::srand(std::time(0));
-
+void MapGenerator::mountainBiome(int biomeID, std::mt19937& rng) {
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
             if (map[row][col] == biomeID) {
                 // Generate a random number between 0 and 99 to determine the biome type
-                int randVal = std::rand() % 100; // Random number between 0 and 99
+                int randVal = randomInt(rng, 100); // Random number between 0 and 99
 
                 if (randVal < 45) {
                     map[row][col] = 3; // 80% chance: Land
@@ -294,22 +416,20 @@ void MapGenerator::fillUnassignedWithSea() {
     }
 }
 
-void MapGenerator::smoothMap() {
+void MapGenerator::smoothMap(ScratchArena& scratch, int smoothingIterations) {
     // Create a copy of the map to store new values (to prevent modifying while iterating)
-    std::vector<std::vector<int>> newMap = map;
+    ScratchGrid newMap = scratchCopy(map, scratch);
 
     // Directions for checking neighbors: up, down, left, right, and diagonals
-    std::vector<std::pair<int, int>> directions = {
+    static constexpr std::pair<int, int> directions[] = {
         {-1, 0}, {1, 0}, {0, -1}, {0, 1},  // Cardinal directions
         {-1, -1}, {-1, 1}, {1, -1}, {1, 1}  // Diagonal directions
     };
 
-    // Number of smoothing iterations (you can adjust this number for more/less smoothing)
-    int smoothingIterations = 6;
-
     for (int iter = 0; iter < smoothingIterations; ++iter) {
         // Iterate over the entire map
         for (int row = 0; row < rows; ++row) {
+            if (stopRequested()) return; // the map is thrown away
             for (int col = 0; col < cols; ++col) {
                 // Skip tiles that haven't been assigned yet
                 if (map[row][col] == -1) {
@@ -442,32 +562,28 @@ void MapGenerator::smoothMap() {
         }
 
         // Update the original map with the new values after one iteration
-        map = newMap;
+        copyInto(newMap, map);
     }
 }
 
 
-void MapGenerator::blendMap() {
+void MapGenerator::blendMap(std::mt19937& rng, ScratchArena& scratch, int smoothingIterations) {
     // Create a copy of the map to store new values (to prevent modifying while iterating)
-    std::vector<std::vector<int>> newMap = map;
+    ScratchGrid newMap = scratchCopy(map, scratch);
 
     // Directions for checking neighbors: up, down, left, right, and diagonals
-    std::vector<std::pair<int, int>> directions = {
+    static constexpr std::pair<int, int> directions[] = {
         {-1, 0}, {1, 0}, {0, -1}, {0, 1},  // Cardinal directions
         {-1, -1}, {-1, 1}, {1, -1}, {1, 1}  // Diagonal directions
     };
 
-    // Number of smoothing iterations (you can adjust this number for more/less smoothing)
-    int smoothingIterations = 3;
-
-    // Random number generator for weighted random selection
-    std::random_device rd;
-    std::default_random_engine rng(rd());
+    // Weighted random selection
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 
     for (int iter = 0; iter < smoothingIterations; ++iter) {
         // Iterate over the entire map
         for (int row = 0; row < rows; ++row) {
+            if (stopRequested()) return; // the map is thrown away
             for (int col = 0; col < cols; ++col) {
                 // Skip tiles that haven't been assigned yet
                 if (map[row][col] == -1) {
@@ -572,16 +688,14 @@ void MapGenerator::blendMap() {
         }
 
         // After completing the iteration, copy the newMap back to the original map
-        map = newMap;
+        copyInto(newMap, map);
     }
 }
 
 
 // Function to apply the modifiers based on map position and surroundings
-void MapGenerator::applyModifiers() {
-    // Random number generator for probabilities
-    std::random_device rd;
-    std::default_random_engine rng(rd());
+void MapGenerator::applyModifiers(std::mt19937& rng) {
+    // Probabilities
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 
     // Iterate over the entire map to apply modifiers
@@ -604,56 +718,12 @@ void MapGenerator::applyModifiers() {
                 }
             }
 
-            // 2. Ice conversion based on proximity to top or bottom
-            if (row < 2 || row >= rows - 2) {
-                map[row][col] = 7;  // Convert to ice
-            } else if ((row >= 2 && row <= 4) || (row >= rows - 4 && row < rows - 2)) {
-                // 50% chance of becoming ice
-                if (dist(rng) < 0.5f) {
-                    map[row][col] = 7;  // Convert to ice
-                }
-            }
-
-            // 3. Tundra conversion based on proximity to top or bottom
-            if (map[row][col] == 1) {  // Land
-                if ((row >= 4 && row <= 20) || (row >= rows - 20 && row < rows - 4)) {
-                    map[row][col] = 8;  // Convert to tundra
-                } else if ((row >= 20 && row <= 35) || (row >= rows - 35 && row < rows - 20)) {
-                    // 50% chance of becoming tundra
-                    if (dist(rng) < 0.5f) {
-                        map[row][col] = 8;  // Convert to tundra
-                    }
-                }
-            }
-            if (map[row][col] == 2) {  // Hills
-                if ((row >= 4 && row <= 20) || (row >= rows - 20 && row < rows - 4)) {
-                    map[row][col] = 9;  // Convert to tundra hills
-                } else if ((row >= 20 && row <= 35) || (row >= rows - 35 && row < rows - 20)) {
-                    // 50% chance of becoming tundra hills
-                    if (dist(rng) < 0.5f) {
-                        map[row][col] = 9;  // Convert to tundra hills
-                    }
-                }
-            }
-
-            // 4. Check if surrounded only by mountains or mountains + ice
+            // 2. Check if surrounded only by mountains or mountains + ice
             if (isSurroundedByMountainsOrIce(row, col)) {
                 if (dist(rng) < 0.5f) {
                     map[row][col] = 7;  // Convert to ice
                 }
             }
-
-            // 5. Desert conversion based on proximity to equator
-            if (row >= rows / 3 && row < 2 * rows / 3) {  // Equatorial band
-                if (map[row][col] == 1) {  // Land
-                    map[row][col] = 12;  // Convert to desert
-                } else if (map[row][col] == 2) {  // Hills
-                    int randVal = std::rand() % 100; // Random number between 0 and 99
-                    if (randVal < 40) {
-                        map[row][col] = 12; // 80% chance: Land
-                    }
-                }
-            }
         }
     }
 }
@@ -661,24 +731,32 @@ void MapGenerator::applyModifiers() {
 
 
 // Function to apply the modifiers based on map position and surroundings
-void MapGenerator::MountainPeaks() {
-    // Random number generator for probabilities
-    std::random_device rd;
-    std::default_random_engine rng(rd());
+void MapGenerator::MountainPeaks(std::mt19937& rng, ScratchArena& scratch) {
+    // Probabilities
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 
-    // Iterate over the entire map to apply modifiers
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            // Skip tiles that haven't been assigned yet
-            if (map[row][col] == -1) {
-                continue;
-            }
+    // Mountains and ice. A tile that turns to ice joins the mask, which can close
+    // the ring around tiles later in the scan, so candidates are taken a word at
+    // a time from the mask as it stands when the scan gets there.
+    TileMask peaks = TileMask::fromMap(map, [](int tile) { return tile == 3 || tile == 7; }, &scratch);
+    TileMask unassigned = TileMask::fromMap(map, [](int tile) { return tile == -1; }, &scratch);
 
+    for (int row = 0; row < rows; ++row) {
+        for (int w = 0; w < peaks.getWordsPerRow(); ++w) {
             // 3. Check if surrounded only by mountains or mountains + ice
-            if (isSurroundedByMountainsOrIce(row, col)) {
+            std::uint64_t pending = peaks.allNeighbourWord(row, w, Connectivity::Eight) & ~unassigned.word(row, w);
+            while (pending) {
+                const int bit = std::countr_zero(pending);
+                const int col = (w << 6) + bit;
+                pending &= pending - 1;
                 if (dist(rng) < 0.5f) {
+                    const bool wasPeak = peaks.test(row, col);
                     map[row][col] = 7;  // Convert to ice
+                    if (!wasPeak) {
+                        peaks.set(row, col);
+                        const std::uint64_t later = ~((std::uint64_t(2) << bit) - 1);
+                        pending = peaks.allNeighbourWord(row, w, Connectivity::Eight) & ~unassigned.word(row, w) & later;
+                    }
                 }
             }
         }
@@ -689,7 +767,7 @@ void MapGenerator::MountainPeaks() {
 // Helper function to check if a tile is surrounded only by mountains or mountains + ice
 bool MapGenerator::isSurroundedByMountainsOrIce(int row, int col) {
     // Directions for checking neighbors: up, down, left, right, and diagonals
-    std::vector<std::pair<int, int>> directions = {
+    static constexpr std::pair<int, int> directions[] = {
         {-1, 0}, {1, 0}, {0, -1}, {0, 1},  // Cardinal directions
         {-1, -1}, {-1, 1}, {1, -1}, {1, 1}  // Diagonal directions
     };
@@ -711,60 +789,6 @@ bool MapGenerator::isSurroundedByMountainsOrIce(int row, int col) {
 }
 
 
-// Function to apply the modifiers based on map position and surroundings
-void MapGenerator::ForceTundra() {
-    // Random number generator for probabilities
-    std::random_device rd;
-    std::default_random_engine rng(rd());
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-
-    // Iterate over the entire map to apply modifiers
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-
-
-            // 3. Tundra conversion based on proximity to top or bottom
-            if (map[row][col] == 1) {
-                if (row >= 0 && row <= (rows/15) || row >= rows - (rows/15) && row < rows - 0) {
-                    map[row][col] = 8;  // Convert to tundra
-                }
-            }
-            if (map[row][col] == 2) {
-                if (row >= 0 && row <= (rows/15) || row >= rows - (rows/15) && row < rows - 0) {
-                    map[row][col] = 9;  // Convert to tundra hills
-                }
-            }
-        }
-    }
-}
-
-
-// Function to apply the modifiers based on map position and surroundings
-void MapGenerator::ForceDesert() {
-    // Random number generator for probabilities
-    std::random_device rd;
-    std::default_random_engine rng(rd());
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-
-    // Iterate over the entire map to apply modifiers
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            // 5. Desert conversion based on proximity to equator
-            if (row >= rows / 2.3 && row < 2 * rows / 4) {  // Equatorial band
-                if (map[row][col] == 1) {  // Land
-                    map[row][col] = 12;  // Convert to desert
-                } else if (map[row][col] == 2) {  // Hills
-                    map[row][col] = 13;  // Convert to desert hills
-                    int randVal = std::rand() % 100; // Random number between 0 and 99
-                    if (randVal < 40) {
-                        map[row][col] = 12; // 80% chance: Land
-                    }
-                }
-            }
-        }
-    }
-}
-
 void MapGenerator::resetHeightMapToZero(std::vector<std::vector<int>>& heightMap, const std::vector<std::vector<int>>& map) {
     int rows = map.size();
     int cols = map[0].size();
@@ -777,58 +801,15 @@ void MapGenerator::resetHeightMapToZero(std::vector<std::vector<int>>& heightMap
 }
 
 
-std::vector<std::vector<int>> MapGenerator::generateHeightMap() {
-    // Create a height map with the same dimensions as the map
-    std::vector<std::vector<int>> heightMap(rows, std::vector<int>(cols, 0));
+void MapGenerator::generateHeightMap(std::mt19937& rng, ScratchArena& scratch) {
+    // Give the height map the same dimensions as the map, all zero; rows keep their storage from the last map
+    heightMap.resize(rows);
+    for (std::vector<int>& line : heightMap) line.assign(cols, 0);
     // std::cout << "HeightMap size: " << heightMap.size() << " x " << heightMap[0].size() << std::endl;
-    std::vector<std::vector<int>> distanceToSea(rows, std::vector<int>(cols, std::numeric_limits<int>::max()));
-
-    // Helper function: Multi-source BFS to precompute distances to the nearest sea
-    auto precomputeDistances = [&]() {
-        std::queue<std::pair<int, int>> q;
-
-        // Add all sea tiles to the queue and set their distance to 0
-        for (int r = 0; r < rows; ++r) {
-            for (int c = 0; c < cols; ++c) {
-                if (map[r][c] == 0) {  // Sea tile
-                    q.push({r, c});
-                    distanceToSea[r][c] = 0;
-                }
-            }
-        }
-
-        // Directions for adjacent tiles
-        std::vector<std::pair<int, int>> directions = {
-            {-1, 0}, {1, 0}, {0, -1}, {0, 1}  // Cardinal directions
-        };
-
-        // BFS to calculate minimum distance to any sea
-        while (!q.empty()) {
-            auto [curRow, curCol] = q.front();
-            q.pop();
-
-            for (const auto& dir : directions) {
-                int newRow = curRow + dir.first;
-                int newCol = curCol + dir.second;
-
-                // Check if the tile is valid and hasn't been visited yet
-                if (newRow >= 0 && newRow < rows && newCol >= 0 && newCol < cols) {
-                    int newDistance = distanceToSea[curRow][curCol] + 1;
-                    if (newDistance < distanceToSea[newRow][newCol]) {
-                        distanceToSea[newRow][newCol] = newDistance;
-                        q.push({newRow, newCol});
-                    }
-                }
-            }
-        }
-    };
+    // Steps (4-connected) to the nearest sea; a map without sea counts every tile as far inland
+    DistanceField distanceToSea = distanceTo(map, [](int tile) { return tile == 0; }, DistanceMetric::Manhattan, 1, &scratch);
 
-    // Precompute distances to the nearest sea
-    precomputeDistances();
-
-    // Initialize random number generator for 5% chance
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // Chance of a river source
     std::uniform_int_distribution<> dis(1, 100);  // Generates a random number between 1 and 100
 
     // Iterate over all map tiles and calculate the height
@@ -840,7 +821,7 @@ std::vector<std::vector<int>> MapGenerator::generateHeightMap() {
             int numSeas = 0;
 
             // Calculate the number of adjacent hills, mountains, and seas
-            std::vector<std::pair<int, int>> directions = {
+            static constexpr std::pair<int, int> directions[] = {
                 {-1, 0}, {1, 0}, {0, -1}, {0, 1},  // Cardinal directions
                 {-1, -1}, {-1, 1}, {1, -1}, {1, 1}  // Diagonal directions
             };
@@ -873,25 +854,26 @@ std::vector<std::vector<int>> MapGenerator::generateHeightMap() {
             }
 
             // Add precomputed distance from the nearest sea
-            height += distanceToSea[row][col];
+            float seaDistance = distanceToSea.at(row, col);
+            height += std::isinf(seaDistance) ? rows + cols : static_cast<int>(seaDistance);
 
             // If height > 70, check for 5% chance to convert to a river (tile number 5)
             if (height > 50 && height < 70) {
-                int chance = dis(gen);  // Get a random number between 1 and 100
+                int chance = dis(rng);  // Get a random number between 1 and 100
                 if (chance <= 1) {  // 3% chance
                     map[row][col] = 5;  // Convert to river
                     continue;  // Skip further height modification for this tile
                 }
             }
             else if (height > 70) {
-                int chance = dis(gen);  // Get a random number between 1 and 100
+                int chance = dis(rng);  // Get a random number between 1 and 100
                 if (chance <= 1) {  // 1% chance
                     map[row][col] = 5;  // Convert to river
                     continue;  // Skip further height modification for this tile
                 }
             }
             else if (height > 1) {
-                int chance = dis(gen);  // Get a random number between 1 and 100
+                int chance = dis(rng);  // Get a random number between 1 and 100
                 if (chance <= 1) {  // 1% chance
                     map[row][col] = 5;  // Convert to river
                     continue;  // Skip further height modification for this tile
@@ -918,370 +900,277 @@ std::vector<std::vector<int>> MapGenerator::generateHeightMap() {
     //     std::cerr << "Error: heightMap (check 2) is empty or improperly initialized!" << std::endl;
     // }
 
-    return heightMap;
     // The heightMap is now complete and can be used for further processing or rendering
 }
 
 
-void MapGenerator::flowRivers(std::vector<std::vector<int>>& heightMap, std::vector<std::vector<int>>& map) {
-    bool foundRiver = true; // Flag to check if there are more river tiles to process
-    std::srand(std::time(0)); // Seed the random number generator
-
-    while (foundRiver) {
-        foundRiver = false;
-
-        // Iterate through the map to find a river tile
-        for (int row = 0; row < map.size(); ++row) {
-            for (int col = 0; col < map[row].size(); ++col) {
-                if (map[row][col] == 5) {
-                    // Process the river tile
-                    map[row][col] = 6; // Mark as processed
-                    heightMap[row][col] = 200;
-                    foundRiver = true; // Mark that we found a tile to process
-                    // std::cout << "Processed tile at (" << row << ", " << col << ")\n";
-
-                    // Find adjacent tiles
-                    std::vector<std::pair<int, int>> adjacentTiles;
-                    int minHeight = std::numeric_limits<int>::max();  // Initialize with the highest possible value
-                    std::pair<int, int> minTile = {-1, -1};  // To store the position of the tile with the minimum height
-
-                    for (int dr = -1; dr <= 1; ++dr) {
-                        for (int dc = -1; dc <= 1; ++dc) {
-                            int adjRow = row + dr;
-                            int adjCol = col + dc;
-
-                            // Ensure we stay within the map bounds
-                            if (adjRow >= 0 && adjRow < map.size() && adjCol >= 0 && adjCol < map[row].size()) {
-                                // Skip the current tile and check only valid adjacent tiles
-                                if (!(dr == 0 && dc == 0)) {
-                                    // Find the minimum height among the adjacent tiles
-                                    if (heightMap[adjRow][adjCol] < minHeight) {
-                                        minHeight = heightMap[adjRow][adjCol];
-                                        minTile = {adjRow, adjCol};
-                                    }
-                                }
-                            }
-                        }
-                    }
-
-                    // If a valid adjacent tile with the minimum height is found, set it to 6
-                    if (minTile.first != -1 && minTile.second != -1) {
-                        int adjRow = minTile.first;
-                        int adjCol = minTile.second;
-
-                        // Set the selected adjacent tile to 6
-                        if (map[adjRow][adjCol] != 0 && map[adjRow][adjCol] != 6) {
-                            map[adjRow][adjCol] = 5;
-                        }
-                        else {break;}
-                        // std::cout << "Processed adjacent tile at (" << adjRow << ", " << adjCol << ")\n";
-                        // std::cout << "Adjacent tile height (" << heightMap[adjRow][adjCol] << ")\n";
-                    }
-
-                    break; // Exit inner loop after processing the river tile
-                }
-            }
-            if (foundRiver) break; // Exit outer loop if a river tile was found
+// Optional: carves drainage into the height map before flowRivers follows it.
+// Sea and lakes are outlets the droplets run off into.
+void MapGenerator::erodeHeightMap(std::mt19937& rng, ScratchArena& scratch) {
+    // The erosion constants suit heights of order one; the height map runs 0..~150
+    const float scale = 100.f;
+    std::pmr::vector<float> height(static_cast<std::size_t>(rows) * cols, &scratch);
+    std::pmr::vector<std::uint8_t> outlets(height.size(), &scratch);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            const int tile = map[row][col];
+            const std::size_t index = static_cast<std::size_t>(row) * cols + col;
+            height[index] = static_cast<float>(heightMap[row][col]) / scale;
+            outlets[index] = tile == 0;
         }
     }
-}
-
-
-
-void MapGenerator::changeSmallSeasToRivers(std::vector<std::vector<int>>& map) {
-    // Direction vectors for 8-connected neighbors (N, NE, E, SE, S, SW, W, NW)
-    const std::vector<std::pair<int, int>> directions = {
-        {-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
-    };
-    
-    // Helper function to perform a DFS flood fill
-    auto floodFill = [&](int row, int col, std::vector<std::vector<int>>& visited) {
-        std::stack<std::pair<int, int>> stack;  // Stack for DFS
-        stack.push({row, col});
-        visited[row][col] = 1;  // Mark as visited
-        
-        int seaSize = 0;
-        std::vector<std::pair<int, int>> seaTiles;  // To store the sea tiles
-
-        while (!stack.empty()) {
-            auto [r, c] = stack.top();
-            stack.pop();
-            seaSize++;
-            seaTiles.push_back({r, c});
-
-            // Check all 8 adjacent directions
-            for (const auto& dir : directions) {
-                int adjRow = r + dir.first;
-                int adjCol = c + dir.second;
 
-                if (adjRow >= 0 && adjRow < map.size() && adjCol >= 0 && adjCol < map[0].size()) {
-                    if (map[adjRow][adjCol] == 0 && visited[adjRow][adjCol] == 0) {
-                        visited[adjRow][adjCol] = 1;  // Mark as visited
-                        stack.push({adjRow, adjCol});
-                    }
+    // River sources were left at height 0; give the droplets the ground around them instead of a pit
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            if (map[row][col] != 5) continue;
+            float total = 0.f;
+            int count = 0;
+            for (int dr = -1; dr <= 1; ++dr) {
+                for (int dc = -1; dc <= 1; ++dc) {
+                    const int r = row + dr, c = col + dc;
+                    if (r < 0 || r >= rows || c < 0 || c >= cols || map[r][c] == 5) continue;
+                    total += height[static_cast<std::size_t>(r) * cols + c];
+                    ++count;
                 }
             }
+            if (count > 0) height[static_cast<std::size_t>(row) * cols + col] = total / static_cast<float>(count);
         }
-        return std::make_pair(seaSize, seaTiles);
-    };
-
-    // Initialize a visited grid with 0s (unvisited)
-    std::vector<std::vector<int>> visited(map.size(), std::vector<int>(map[0].size(), 0));
+    }
 
-    // Iterate over the map to find sea tiles (0 represents sea)
-    for (int row = 0; row < map.size(); ++row) {
-        for (int col = 0; col < map[row].size(); ++col) {
-            if (map[row][col] == 0 && visited[row][col] == 0) {  // Found an unvisited sea tile
-                auto [seaSize, seaTiles] = floodFill(row, col, visited);
+    erodeHeightfield(height, rows, cols, outlets, rng(), erosionSettings, stageThreads(), &scratch, cancelFlag);
+    if (stopRequested()) return; // the map is thrown away
 
-                // If the sea is smaller than 100 tiles, change all its tiles to river (5)
-                int minSeaSize = cols/3;
-                if (seaSize < minSeaSize) {
-                    for (const auto& tile : seaTiles) {
-                        map[tile.first][tile.second] = 16;  // Change sea to river
-                    }
-                    // std::cout << "Small sea found with size " << seaSize << " at (" << row << ", " << col << "), converted to river.\n";
-                }
-            }
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            const std::size_t index = static_cast<std::size_t>(row) * cols + col;
+            if (!outlets[index] && map[row][col] != 5) heightMap[row][col] = static_cast<int>(std::lround(height[index] * scale));
         }
     }
-}
-
-
-void MapGenerator::changeDesertToFloodplains(std::vector<std::vector<int>>& map) {
-    // Direction vectors for 8-connected neighbors (N, NE, E, SE, S, SW, W, NW)
-    const std::vector<std::pair<int, int>> directions = {
-        {-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
-    };
 
-    // Iterate over the map to check desert tiles (value 12) adjacent to river tiles (value 16)
-    for (int row = 0; row < map.size(); ++row) {
-        for (int col = 0; col < map[row].size(); ++col) {
-            if (map[row][col] == 12) {  // Check if the current tile is a desert tile
-                // Check adjacent tiles
-                for (const auto& dir : directions) {
-                    int adjRow = row + dir.first;
-                    int adjCol = col + dir.second;
-
-                    if (adjRow >= 0 && adjRow < map.size() && adjCol >= 0 && adjCol < map[row].size()) {
-                        if (map[adjRow][adjCol] == 6) {  // If adjacent tile is a river (16)
-                            map[row][col] = 17;  // Change desert tile to floodplain (17)
-                            // std::cout << "Changed desert tile at (" << row << ", " << col << ") to floodplain.\n";
-                            break;  // Stop checking other adjacent tiles once the change is made
-                        }
-                    }
+    // Droplets leave small pits where they drop sediment, and flowRivers climbs out
+    // of any pit the hard way. Priority-flood from the sea raises every pit to its
+    // spill point plus a step, so each tile has a strictly lower neighbour on a path
+    // to the sea. Sources keep their 0 but pass the flood on at their level.
+    std::priority_queue<std::pair<int, int>, std::pmr::vector<std::pair<int, int>>, std::greater<>> open{
+        std::greater<>(), std::pmr::vector<std::pair<int, int>>(&scratch)};
+    std::pmr::vector<std::uint8_t> reached(outlets.size(), 0, &scratch);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            if (map[row][col] != 0) continue;
+            reached[static_cast<std::size_t>(row) * cols + col] = 1;
+            open.push({heightMap[row][col], row * cols + col});
+        }
+    }
+    while (!open.empty()) {
+        const auto [level, index] = open.top();
+        open.pop();
+        const int row = index / cols, col = index % cols;
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                const int r = row + dr, c = col + dc;
+                if (r < 0 || r >= rows || c < 0 || c >= cols || reached[static_cast<std::size_t>(r) * cols + c]) continue;
+                reached[static_cast<std::size_t>(r) * cols + c] = 1;
+                if (map[r][c] == 5) {
+                    open.push({level + 1, r * cols + c});
+                    continue;
                 }
+                heightMap[r][c] = std::max(heightMap[r][c], level + 1);
+                open.push({heightMap[r][c], r * cols + c});
             }
         }
     }
 }
 
+void MapGenerator::flowRivers(std::vector<std::vector<int>>& heightMap, std::vector<std::vector<int>>& map,
+                              ScratchArena& scratch) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = rows > 0 ? static_cast<int>(map[0].size()) : 0;
 
-void MapGenerator::applyForestChance(std::vector<std::vector<int>>& map) {
-    // Seed the random number generator (if not done previously)
-    std::srand(std::time(nullptr));
-
-    // Get map dimensions
-    int rows = map.size();
-    int cols = map[0].size();
-
-    // Iterate over the map
+    // Always process the pending river source (5) with the lowest row-major index,
+    // exactly as rescanning the map from the top after every step would, but
+    // without the rescan. A tile can be queued twice; the second pop is skipped.
+    std::priority_queue<int, std::pmr::vector<int>, std::greater<int>> pending{std::greater<int>(),
+                                                                               std::pmr::vector<int>(&scratch)};
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
-            int tile = map[row][col];
-
-            // Calculate the weighted chance based on row position
-            double chance = 0;  // Base chance for forest creation
-
-            // Weighted by position: top sixth or bottom sixth gets higher chance
-            if (row < rows / 2.5 || row >= 5 * rows / 6.3) {
-                chance = 0.1;  // Increase the chance for top and bottom sixth
-            }
-            // Weighted by position: top sixth or bottom sixth gets higher chance
-            if (row < rows / 4.3 || row >= 5 * rows / 6.1) {
-                chance = 0.5;  // Increase the chance for top and bottom sixth
-            }
-            // Weighted by position: top sixth or bottom sixth gets higher chance
-            if (row < rows / 5.5 || row >= 5 * rows / 5.6) {
-                chance = 0.7;  // Increase the chance for top and bottom sixth
-            }
-
+            if (map[row][col] == 5) pending.push(row * cols + col);
+        }
+    }
 
-            // Apply random chance to land (1) and hills (2)
-            if (tile == 1) {  // Land tile
-                if (static_cast<double>(std::rand()) / RAND_MAX < chance) {
-                    map[row][col] = 18;  // Turn into forest (18)
-                    // std::cout << "Land at (" << row << ", " << col << ") turned into forest.\n";
-                }
-            } else if (tile == 2) {  // Hill tile
-                if (static_cast<double>(std::rand()) / RAND_MAX < chance) {
-                    map[row][col] = 19;  // Turn into forest hill (19)
-                    // std::cout << "Hill at (" << row << ", " << col << ") turned into forest hill.\n";
+    for (long long steps = 1; !pending.empty(); ++steps) {
+        if (steps % 4096 == 0 && stopRequested()) return;
+        int index = pending.top();
+        pending.pop();
+        int row = index / cols;
+        int col = index % cols;
+        if (map[row][col] != 5) continue;
+
+        map[row][col] = 6; // Mark as processed
+        heightMap[row][col] = 200;
+
+        // Flow to the lowest neighbour (first found wins ties)
+        int minHeight = std::numeric_limits<int>::max();
+        int minRow = -1;
+        int minCol = -1;
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                int adjRow = row + dr;
+                int adjCol = col + dc;
+                if ((dr != 0 || dc != 0) && adjRow >= 0 && adjRow < rows && adjCol >= 0 && adjCol < cols &&
+                    heightMap[adjRow][adjCol] < minHeight) {
+                    minHeight = heightMap[adjRow][adjCol];
+                    minRow = adjRow;
+                    minCol = adjCol;
                 }
             }
         }
+
+        // The river stops when it reaches the sea or another river
+        if (minRow != -1 && map[minRow][minCol] != 0 && map[minRow][minCol] != 6) {
+            map[minRow][minCol] = 5;
+            pending.push(minRow * cols + minCol);
+        }
     }
 }
 
 
 
-void MapGenerator::convertToTaiga(std::vector<std::vector<int>>& map) {
-    int rows = map.size();
-    int cols = map[0].size();
-    
-    // Calculate the indices for the top and bottom 1/6 of the map
-    int topLimit = rows / 6.5;
-    int bottomLimit = 5 * rows / 6;
+void MapGenerator::changeSmallSeasToRivers(std::vector<std::vector<int>>& map, ScratchArena& scratch) {
+    // Seas (0) are 8-connected; any smaller than a third of the map width become lakes
+    ComponentLabels seas = labelComponents(map, [](int tile) { return tile == 0; }, Connectivity::Eight, 1, &scratch);
+    const int minSeaSize = cols / 3;
 
-    // Iterate over the top 1/6th of the map
-    for (int row = 0; row < topLimit; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            if (map[row][col] == 1) {
-                // Land tile, change to taiga
-                map[row][col] = 10; // Taiga
-            } else if (map[row][col] == 2) {
-                // Hill tile, change to taiga hills
-                map[row][col] = 11; // Taiga Hills
+    for (int row = 0; row < seas.rows; ++row) {
+        for (int col = 0; col < seas.cols; ++col) {
+            int sea = seas.at(row, col);
+            if (sea != -1 && seas.components[sea].size < minSeaSize) {
+                map[row][col] = 16;  // Change sea to lake
             }
         }
     }
+}
 
-    // Iterate over the bottom 1/6th of the map
-    for (int row = bottomLimit; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            if (map[row][col] == 1) {
-                // Land tile, change to taiga
-                map[row][col] = 10; // Taiga
-            } else if (map[row][col] == 2) {
-                // Hill tile, change to taiga hills
-                map[row][col] = 11; // Taiga Hills
+
+// Height above the sea for the climate, 0 at sea level to 1 at the 99.5th
+// percentile and above. Noise maps use their continuous heightfield; the others
+// the height map, which generateHeightMap measures in steps from the sea plus a
+// bit for the ground class, and erosion may have carved. Both rise about evenly
+// from the coast, so the result is squared: lowlands stay near sea level and
+// the cold and the rain shadows come from the high ground. River tiles hold
+// flowRivers' 200 marker rather than a height; the climate counts them as
+// water and never reads it, so they are left at sea level here.
+std::pmr::vector<float> MapGenerator::climateHeight(ScratchArena& scratch) const {
+    std::pmr::vector<float> height(static_cast<std::size_t>(rows) * cols, 0.f, &scratch);
+    if (!elevation.empty()) {
+        std::copy(elevation.begin(), elevation.end(), height.begin());
+    } else {
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                const int tile = map[row][col];
+                if (tile != 5 && tile != 6) height[static_cast<std::size_t>(row) * cols + col] = static_cast<float>(heightMap[row][col]);
             }
         }
     }
-}
-
 
+    static constexpr float fractions[] = {NoiseSeaFraction, 0.995f};
+    const std::pmr::vector<float> cuts = heightQuantiles(height, fractions, &scratch);
+    const float seaLevel = elevation.empty() ? 0.f : cuts[0]; // the height map has the sea at 0
+    const float range = std::max(cuts[1] - seaLevel, 1e-6f);
+    for (float& value : height) {
+        const float above = std::clamp((value - seaLevel) / range, 0.f, 1.f);
+        value = above * above;
+    }
+    return height;
+}
 
-void MapGenerator::applyJungleChance(std::vector<std::vector<int>>& map) {
-    // Seed the random number generator (if not done previously)
-    std::srand(std::time(nullptr));
-
-    // Get map dimensions
-    int rows = map.size();
-    int cols = map[0].size();
 
-    // Iterate over the map
+// Biomes in one pass from the climate: land and hills look theirs up in the
+// Whittaker table, and anything below freezing (sea and mountains included)
+// becomes ice. A little jitter on both fields breaks up the band edges.
+void MapGenerator::assignBiomes(std::mt19937& rng) {
+    std::uniform_real_distribution<float> jitter(-1.0f, 1.0f);
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
-            int tile = map[row][col];
-
-            // Calculate the weighted chance based on row position (tropical zones)
-            double chance = 0;  // Base chance for jungle creation
-            // Weighted by position: middle of the map (near the tropics) gets higher chance
-            if (row >= rows / 3 && row <= 2 * rows / 3) {
-                chance = 0.2;  // Moderate chance in the tropical region
-            }
-            // Weighted by position: middle of the map (near the tropics) gets higher chance
-            if (row >= rows / 2.6 && row <= 2 * rows / 3.2) {
-                chance = 0.4;  // Moderate chance in the tropical region
-            }
-            // Weighted by position: middle of the map (near the tropics) gets higher chance
-            if (row >= rows / 2.4 && row <= 2 * rows / 3.4) {
-                chance = 0.7;  // Moderate chance in the tropical region
-            }
+            const int tile = map[row][col];
+            if (tile < 0 || tile > 3) continue;  // Sea, land, hills and mountains only
 
-            // Apply random chance to land (1) and hills (2)
-            if (tile == 1) {  // Land tile
-                if (static_cast<double>(std::rand()) / RAND_MAX < chance) {
-                    map[row][col] = 20;  // Turn into jungle (20)
-                    // std::cout << "Land at (" << row << ", " << col << ") turned into jungle.\n";
-                }
-            } else if (tile == 2) {  // Hill tile
-                if (static_cast<double>(std::rand()) / RAND_MAX < chance) {
-                    map[row][col] = 21;  // Turn into jungle hill (21)
-                    // std::cout << "Hill at (" << row << ", " << col << ") turned into jungle hill.\n";
-                }
+            const float temperature = climate.temperatureAt(row, col) + 2.0f * jitter(rng);
+            if (tile == 0 || tile == 3) {
+                if (temperature < FreezingTemperature) map[row][col] = 7;  // Sea ice / ice cap
+                continue;
             }
+            const float moisture = climate.moistureAt(row, col) + 0.06f * jitter(rng);
+            map[row][col] = whittakerBiome(tile, temperature, moisture);
         }
     }
 }
 
 
-void MapGenerator::applyCoastChance(std::vector<std::vector<int>>& map) {
-    // Seed the random number generator (if not done previously)
-    std::srand(std::time(nullptr));
+// Marks the sea-side tile classes (sea, ice, coast, ocean). The finishing passes
+// check this mask before touching a tile, so land passes and water passes never
+// read or write the same tiles and can run at the same time.
+void MapGenerator::classifyWater(ScratchArena& scratch) {
+    waterMask.resize(rows);
+    for (std::vector<unsigned char>& line : waterMask) line.assign(cols, 0);
+    std::pmr::vector<std::uint8_t> land(static_cast<std::size_t>(rows) * cols, &scratch);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            int tile = map[row][col];
+            waterMask[row][col] = (tile == 0 || tile == 7 || tile == 22 || tile == 23);
+            land[row * cols + col] = !waterMask[row][col];
+        }
+    }
+    // The water passes read how far each tile is from land instead of scanning around it.
+    // Both are built in scratch and copied into the members' own storage.
+    waterTiles = TileMask::fromTiles(rows, cols, [&](int row, int col) { return waterMask[row][col] != 0; }, &scratch);
+    landDistance = distanceTransform(land, rows, cols, DistanceMetric::Euclidean, 1, &scratch);
+}
 
-    // Get map dimensions
-    int rows = map.size();
-    int cols = map[0].size();
 
-    // Directions for neighboring tiles (including diagonals)
-    std::vector<std::pair<int, int>> directions = {
-        {-1, 0}, {1, 0}, {0, -1}, {0, 1},   // N, S, W, E
-        {-1, -1}, {-1, 1}, {1, -1}, {1, 1}  // NE, NW, SE, SW
+void MapGenerator::changeDesertToFloodplains(std::vector<std::vector<int>>& map, ScratchArena& scratch) {
+    // Desert (12) touching a river (6), diagonals included, becomes floodplain (17).
+    // Only land-side tiles are read; the water passes may be writing the rest.
+    const int mapRows = static_cast<int>(map.size());
+    const int mapCols = mapRows > 0 ? static_cast<int>(map[0].size()) : 0;
+    auto landTile = [&](int tile) {
+        return [&, tile](int row, int col) { return !waterMask[row][col] && map[row][col] == tile; };
     };
+    TileMask rivers = TileMask::fromTiles(mapRows, mapCols, landTile(6), &scratch);
+    TileMask deserts = TileMask::fromTiles(mapRows, mapCols, landTile(12), &scratch);
 
-    // Iterate over the map to find sea tiles
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            if (map[row][col] == 0) {  // Sea tile found
-                bool adjacentToLand = false;
-                bool moreAdjacentToLand = false;
-                // Check neighboring tiles within a 1-tile radius
-                for (int dr = -1; dr <= 1; ++dr) {
-                    for (int dc = -1; dc <= 1; ++dc) {
-                        // Ensure we stay within the bounds of the map
-                        int newRow = row + dr;
-                        int newCol = col + dc;
-                        if (newRow >= 0 && newRow < rows && newCol >= 0 && newCol < cols) {
-                            // Check if the neighbor is non-sea and non-ice
-                            if (map[newRow][newCol] != 0 && map[newRow][newCol] != 7 && map[newRow][newCol] != 22) {
-                                moreAdjacentToLand = true;
-                                break;
-                            }
-                        }
-                    }
-                    if (moreAdjacentToLand) break;
-                }
-                // Check neighboring tiles within a 2-tile radius
-                for (int dr = -2; dr <= 2; ++dr) {
-                    for (int dc = -2; dc <= 2; ++dc) {
-                        // Ensure we stay within the bounds of the map
-                        int newRow = row + dr;
-                        int newCol = col + dc;
-                        if (newRow >= 0 && newRow < rows && newCol >= 0 && newCol < cols) {
-                            // Check if the neighbor is non-sea and non-ice
-                            if (map[newRow][newCol] != 0 && map[newRow][newCol] != 7 && map[newRow][newCol] != 22) {
-                                adjacentToLand = true;
-                                break;
-                            }
-                        }
-                    }
-                    if (adjacentToLand) break;
-                }
+    (deserts & rivers.anyNeighbour(Connectivity::Eight)).forEachSet([&](int row, int col) {
+        map[row][col] = 17;
+    });
+}
 
-                // If the sea tile is adjacent to non-sea, non-ice tile, apply a 50% chance to turn into coast
-                if (adjacentToLand) {
-                    if (static_cast<double>(std::rand()) / RAND_MAX < 0.5) {
-                        map[row][col] = 22;  // Turn into coast (22)
-                        // std::cout << "Sea at (" << row << ", " << col << ") turned into coast.\n";
-                    }
-                }
-                if (moreAdjacentToLand) {
-                    if (static_cast<double>(std::rand()) / RAND_MAX < 1) {
-                        map[row][col] = 22;  // Turn into coast (22)
-                        // std::cout << "Sea at (" << row << ", " << col << ") turned into coast.\n";
-                    }
-                }
+
+void MapGenerator::applyCoastChance(std::vector<std::vector<int>>& map, std::mt19937& rng, ScratchArena& scratch) {
+    // Sea (0) within one tile of land, diagonals included, and within two tiles
+    TileMask land(waterTiles, &scratch);
+    land.invert();
+    TileMask nextToLand = land.dilate(Connectivity::Eight);
+    TileMask nearLand = nextToLand.dilate(Connectivity::Eight);
+    TileMask seas = TileMask::fromTiles(waterTiles.getRows(), waterTiles.getCols(),
+                                        [&](int row, int col) { return waterMask[row][col] && map[row][col] == 0; },
+                                        &scratch);
+
+    // Visited in row-major order so the random draws land on the same tiles as a full scan
+    (seas & nearLand).forEachSet([&](int row, int col) {
+        // Sea within two tiles of land has a 50% chance to turn into coast
+        if (randomUnit(rng) < 0.5) {
+            map[row][col] = 22;  // Turn into coast (22)
+        }
+        // and always does right next to land
+        if (nextToLand.test(row, col)) {
+            if (randomUnit(rng) < 1) {
+                map[row][col] = 22;  // Turn into coast (22)
             }
         }
-    }
+    });
 }
 
-void MapGenerator::applyDeepOceanChance(std::vector<std::vector<int>>& map) {
-    // Seed the random number generator (if not done previously)
-    std::srand(std::time(nullptr));
-
+void MapGenerator::applyDeepOceanChance(std::vector<std::vector<int>>& map, std::mt19937& rng) {
     // Get map dimensions
     int rows = map.size();
     int cols = map[0].size();
@@ -1289,172 +1178,18 @@ void MapGenerator::applyDeepOceanChance(std::vector<std::vector<int>>& map) {
     // Iterate over the map
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
+            if (!waterMask[row][col]) continue;
             int tile = map[row][col];
 
-            // Calculate the weighted chance based on row position
-            double chance = 0.3;
+            // Open sea gets deeper away from land: no ocean near the coast, then a
+            // rising chance out to mostly ocean in the middle of large seas
+            double chance = std::clamp((landDistance.at(row, col) - 3.0) / 10.0, 0.0, 0.9);
 
-            // Apply random chance to land (1) and hills (2)
-            if (tile == 0) {  // Land tile
-                if (static_cast<double>(std::rand()) / RAND_MAX < chance) {
+            if (tile == 0) {  // Sea tile
+                if (randomUnit(rng) < chance) {
                     map[row][col] = 23;  // Turn into ocean
-                    // std::cout << "Land at (" << row << ", " << col << ") turned into jungle.\n";
                 }
             }
         }
     }
 }
-
-
-sf::Color MapGenerator::getTileColor(int tileType) const {
-    switch (tileType) {
-        case 0: return sf::Color::Blue;                     // Sea
-        // case 1: return sf::Color::Green;                    // Land
-        case 1: return {154, 255, 0};                    // Land
-        case 2: return {165, 217, 117};                     // Hills
-        case 3: return {169, 169, 169};                     // Mountain
-        case 5: return sf::Color::Red;                      // River source
-        // case 6: return {0, 128, 255};                       // River
-        case 6: return {0, 94, 255};                       // River
-        case 7: return sf::Color::White;                    // Ice
-        case 8: return {149, 158, 133};                     // Tundra
-        case 9: return {191, 201, 171};                     // Tundra hills
-        case 10: return {70, 97, 24};                       // Taiga
-        case 11: return {109, 148, 41};                     // Taiga hills
-        case 12: return {255, 236, 91};                     // Desert
-        case 13: return {224, 181, 81};                     // Desert hills
-        case 14: return sf::Color::Red;                     // River source again?
-        case 15: return sf::Color::White;                   // Ice cap
-        // case 16: return {2, 113, 224};                      // Lake
-        case 16: return {0, 94, 255};                      // Lake
-        case 17: return {137, 227, 0};                       // Floodplain
-        case 18: return {1, 51, 3};                         // Forest
-        case 19: return {3, 107, 7};                        // Forest hills
-        case 20: return {29, 173, 39};                      // Jungle
-        case 21: return {36, 212, 48};                      // Jungle hills
-        case 22: return {0, 94, 255};                      // Coast
-        // case 22: return {54, 73, 227};                      // Coast
-        default: return sf::Color::Magenta;                // Unknown / debug
-    }
-}
-
-
-
-
-
-
-sf::VertexArray MapGenerator::createGrid(float cellSize) {
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles);
-    vertices.resize(rows * cols * 6); // 2 triangles per cell, 3 vertices each
-
-    // Random number generator for dappling
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> offsetDist(-15, 15); // Small color variation
-
-    auto getColor = [](int tile) -> sf::Color {
-        switch (tile) {
-            case 0: return sf::Color::Blue;
-            case 1: return {154, 255, 0};
-            case 2: return {165, 217, 117};
-            case 3: return {169, 169, 169};
-            case 5: return sf::Color::Red;
-            case 6: return {0, 94, 255};
-            case 7: return sf::Color::White;
-            case 8: return {149, 158, 133};
-            case 9: return {191, 201, 171};
-            case 10: return {70, 97, 24};
-            case 11: return {109, 148, 41};
-            case 12: return {255, 236, 91};
-            case 13: return {224, 181, 81};
-            case 14: return sf::Color::Red;
-            case 15: return sf::Color::White;
-            case 16: return {0, 94, 255};
-            case 17: return {137, 227, 0};
-            case 18: return {1, 51, 3};
-            case 19: return {3, 107, 7};
-            case 20: return {29, 173, 39};
-            case 21: return {36, 212, 48};
-            case 22: return {0, 94, 255};
-            case 23: return sf::Color(22, 0, 224);
-            default: return sf::Color::Magenta;
-        }
-    };
-
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            float x = col * cellSize;
-            float y = row * cellSize;
-
-            // Base color from tile type
-            sf::Color baseColor = getColor(map[row][col]);
-
-            // Dappling: slight random offset per RGB channel
-            int r = std::clamp(baseColor.r + offsetDist(gen), 0, 255);
-            int g = std::clamp(baseColor.g + offsetDist(gen), 0, 255);
-            int b = std::clamp(baseColor.b + offsetDist(gen), 0, 255);
-            sf::Color color(r, g, b);
-
-            int i = (row * cols + col) * 6;
-
-            vertices[i + 0].position = sf::Vector2f(x, y);
-            vertices[i + 0].color = color;
-
-            vertices[i + 1].position = sf::Vector2f(x + cellSize, y);
-            vertices[i + 1].color = color;
-
-            vertices[i + 2].position = sf::Vector2f(x, y + cellSize);
-            vertices[i + 2].color = color;
-
-            vertices[i + 3].position = sf::Vector2f(x, y + cellSize);
-            vertices[i + 3].color = color;
-
-            vertices[i + 4].position = sf::Vector2f(x + cellSize, y);
-            vertices[i + 4].color = color;
-
-            vertices[i + 5].position = sf::Vector2f(x + cellSize, y + cellSize);
-            vertices[i + 5].color = color;
-        }
-    }
-
-    return vertices;
-}
-
-
-
-
-
-
-
-sf::Texture MapGenerator::createGridTexture(float cellSize) {
-    sf::Texture renderTexture(sf::Vector2u(cols * cellSize, rows * cellSize)); // Throws sf::Exception if an error occurs
-}
-
-sf::Color MapGenerator::getColorForTile(int tileType) {
-    switch (tileType) {
-        case 0: return sf::Color::Blue; // Sea
-        case 1: return sf::Color::Green; // Land
-        case 2: return sf::Color(176, 237, 119); // Hills
-        case 3: return sf::Color(169, 169, 169); // Mountain
-        case 5: return sf::Color::Red; // River source
-        case 6: return sf::Color(0, 128, 255); // River
-        case 7: return sf::Color::White; // Ice
-        case 8: return sf::Color(149, 158, 133); // Tundra
-        case 9: return sf::Color(191, 201, 171); // Tundra hills
-        case 10: return sf::Color(70, 97, 24); // Taiga
-        case 11: return sf::Color(109, 148, 41); // Taiga hills
-        case 12: return sf::Color(255, 214, 77); // Desert
-        case 13: return sf::Color(224, 181, 81); // Desert hills
-        case 14: return sf::Color::Red; // River source
-        case 15: return sf::Color::White; // Ice cap
-        case 16: return sf::Color(2, 113, 224); // Lake
-        case 17: return sf::Color(4, 148, 12); // Floodplain
-        case 18: return sf::Color(1, 51, 3); // Forest
-        case 19: return sf::Color(3, 107, 7); // Forest hills
-        case 20: return sf::Color(29, 173, 39); // Jungle
-        case 21: return sf::Color(36, 212, 48); // Jungle hills
-        case 22: return sf::Color(54, 73, 227); // Coast
-        case 23: return sf::Color(22, 0, 224); // Ocean
-        default: return sf::Color::Blue; // Default fallback
-    }
-}
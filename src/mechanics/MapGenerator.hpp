@@ -1,23 +1,38 @@
 #ifndef MAPGENERATOR_HPP
 #define MAPGENERATOR_HPP
 
+#include <atomic>
 #include <vector>
-#include <SFML/Graphics.hpp> // Include SFML Graphics
-#include <cstdlib>
-#include <ctime>
+#include <random>
+#include <string>
+#include "GenerationPipeline.hpp"
+#include "DistanceField.hpp"
+#include "TileMask.hpp"
+#include "Climate.hpp"
+#include "Erosion.hpp"
 
 class MapGenerator {
 public:
-    MapGenerator(int rows, int cols);
-    void generateMap();
+    MapGenerator(int rows, int cols, unsigned int seed = std::random_device{}());
+    // Stages hold pointers back to this generator
+    MapGenerator(const MapGenerator&) = delete;
+    MapGenerator& operator=(const MapGenerator&) = delete;
+
+    // Returns false if the callback or the cancel flag cancelled generation part way through
+    bool generateMap(const ProgressCallback& onStage = {});
+    // Once `flag` (may be null) is set, generation stops after the running stage,
+    // and the long stages (layout, smoothing, noise, erosion, rivers) stop part way through
+    void setCancelFlag(const std::atomic<bool>* flag);
+    int getStageCount() const;
+    bool loadStageConfig(const std::string& path);
+    GenerationPipeline& getPipeline();
+    void setSeed(unsigned int newSeed);
+    unsigned int getSeed() const;
     const std::vector<std::vector<int>>& getMap() const;
-    std::vector<std::vector<int>> generateHeightMap();
-    // In MapGenerator.hpp
-    sf::Color getTileColor(int tileType) const;
-    // std::vector<sf::RectangleShape> createGrid(float cellSize);
-    sf::Texture createGridTexture(float cellSize);
-    sf::Color getColorForTile(int tileType);
-    sf::VertexArray createGrid(float cellSize);
+    const ClimateField& getClimate() const; // set by the computeClimate stage
+    void setErosionSettings(const ErosionSettings& settings); // used by the erodeHeightMap stage
+    void setLayoutScale(int scale); // coarseLayout's resolution divisor, rounded down to a power of two
+    void generateHeightMap(std::mt19937& rng, ScratchArena& scratch); // fills heightMap
 
 private:
     std::vector<std::vector<int>> map;
@@ -27,35 +42,54 @@ private:
     // int rows, cols; // Dimensions of the map
     int seaLevel;
 
-    void initializeMap();
+    GenerationPipeline pipeline;
+    void registerStages();
+    int stageThreads() const;
+    const std::atomic<bool>* cancelFlag = nullptr;
+    bool stopRequested() const;
+
+    void initializeMap(std::mt19937& rng, ScratchArena& scratch);
+    void noiseTerrain(std::mt19937& rng, ScratchArena& scratch);
+    std::vector<float> elevation; // noiseTerrain's heightfield, row-major; empty for the other layouts
+    void coarseLayout(std::mt19937& rng, ScratchArena& scratch);
+    int layoutScale = 4;
+    std::vector<std::vector<int>> layoutMap; // coarseLayout's small map, kept so its storage is reused
 
-    void landBiome(int biomeID);
-    void seaBiome(int biomeID);
-    void mountainBiome(int biomeID);
-    void hillBiome(int biomeID);
+    void landBiome(int biomeID, std::mt19937& rng);
+    void seaBiome(int biomeID, std::mt19937& rng);
+    void mountainBiome(int biomeID, std::mt19937& rng);
+    void hillBiome(int biomeID, std::mt19937& rng);
 
     void fillUnassignedWithSea();
-    void applyModifiers();
+    void applyModifiers(std::mt19937& rng);
     bool isSurroundedByMountainsOrIce(int row, int col);
-    void smoothMap();
-    void blendMap();
+    void smoothMap(ScratchArena& scratch, int smoothingIterations = 6);
+    void blendMap(std::mt19937& rng, ScratchArena& scratch, int smoothingIterations = 3);
 
-    void MountainPeaks();
-    void ForceTundra();
-    void ForceDesert();
+    void MountainPeaks(std::mt19937& rng, ScratchArena& scratch);
 
-    void flowRivers(std::vector<std::vector<int>>& heightMap, std::vector<std::vector<int>>& map);
+    ErosionSettings erosionSettings;
+    void erodeHeightMap(std::mt19937& rng, ScratchArena& scratch);
+    void flowRivers(std::vector<std::vector<int>>& heightMap, std::vector<std::vector<int>>& map, ScratchArena& scratch);
     void resetHeightMapToZero(std::vector<std::vector<int>>& heightMap, const std::vector<std::vector<int>>& map);
-    void changeSmallSeasToRivers(std::vector<std::vector<int>>& map);
+    void changeSmallSeasToRivers(std::vector<std::vector<int>>& map, ScratchArena& scratch);
+
+    ClimateField climate;
+    std::pmr::vector<float> climateHeight(ScratchArena& scratch) const;
+    void assignBiomes(std::mt19937& rng);
 
-    void changeDesertToFloodplains(std::vector<std::vector<int>>& map);
-    void applyForestChance(std::vector<std::vector<int>>& map);
-    void convertToTaiga(std::vector<std::vector<int>>& map);
-    void applyJungleChance(std::vector<std::vector<int>>& map);
-    void applyDeepOceanChance(std::vector<std::vector<int>>& map);
+    std::vector<std::vector<unsigned char>> waterMask; // 1 = sea-side tile class
+    TileMask waterTiles;        // waterMask as bitplanes, set with waterMask
+    DistanceField landDistance; // Euclidean distance to the nearest non-water tile, set with waterMask
+    void classifyWater(ScratchArena& scratch);
 
-    void applyCoastChance(std::vector<std::vector<int>>& map);
+    void changeDesertToFloodplains(std::vector<std::vector<int>>& map, ScratchArena& scratch);
+    void applyDeepOceanChance(std::vector<std::vector<int>>& map, std::mt19937& rng);
+
+    void applyCoastChance(std::vector<std::vector<int>>& map, std::mt19937& rng, ScratchArena& scratch);
     int rows, cols;
+    unsigned int seed;
+
     std::vector<int> tiles; // Replace placeholder type with actual tile data type
 };
 
@@ -0,0 +1,135 @@
+#include "MapScore.hpp"
+#include "Components.hpp"
+#include "Simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+const char* metricName(MapMetric metric) {
+    switch (metric) {
+        case MapMetric::Land: return "land";
+        case MapMetric::Continents: return "continents";
+        case MapMetric::Rivers: return "rivers";
+        case MapMetric::Fairness: return "fairness";
+    }
+    return "";
+}
+
+bool parseMetric(const std::string& name, MapMetric& metric) {
+    for (int i = 0; i < MapMetricCount; ++i) {
+        if (name == metricName(static_cast<MapMetric>(i))) {
+            metric = static_cast<MapMetric>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Rivers only change in flowRivers. Land and walkability settle in assignBiomes:
+// the finishing passes after it only swap land for land and water for water.
+const char* finalAfter(MapMetric metric) {
+    switch (metric) {
+        case MapMetric::Land: return "assignBiomes";
+        case MapMetric::Continents: return "assignBiomes";
+        case MapMetric::Rivers: return "flowRivers";
+        case MapMetric::Fairness: return "";
+    }
+    return "";
+}
+
+static bool isWater(int tile) {
+    return tile == 0 || tile == 7 || tile == 16 || tile == 22 || tile == 23;
+}
+
+double landFraction(const std::vector<std::vector<int>>& map) {
+    long long land = 0, tiles = 0;
+    for (const auto& row : map) {
+        for (int tile : row) land += !isWater(tile);
+        tiles += static_cast<long long>(row.size());
+    }
+    return tiles > 0 ? static_cast<double>(land) / static_cast<double>(tiles) : 0.0;
+}
+
+int continentCount(const std::vector<std::vector<int>>& map) {
+    ComponentLabels landmasses = labelComponents(map, Simulation::isWalkable, Connectivity::Eight);
+    return static_cast<int>(std::count_if(landmasses.components.begin(), landmasses.components.end(),
+                                          [](const Component& c) { return c.size >= Simulation::MinSpawnLandmass; }));
+}
+
+int riverCount(const std::vector<std::vector<int>>& map) {
+    return static_cast<int>(labelComponents(map, [](int tile) { return tile == 6; }, Connectivity::Eight).components.size());
+}
+
+double spawnFairness(const std::vector<std::vector<int>>& map, const std::vector<std::vector<float>>& fertility) {
+    const int rows = static_cast<int>(map.size());
+    const int cols = rows > 0 ? static_cast<int>(map[0].size()) : 0;
+    if (rows == 0 || cols == 0) return 0.0;
+
+    // Summed-area table of fertility, so each window is four lookups
+    std::vector<double> sums(static_cast<std::size_t>(rows + 1) * (cols + 1), 0.0);
+    for (int r = 0; r < rows; ++r) {
+        double line = 0.0;
+        for (int c = 0; c < cols; ++c) {
+            line += fertility[r][c];
+            sums[static_cast<std::size_t>(r + 1) * (cols + 1) + c + 1] = sums[static_cast<std::size_t>(r) * (cols + 1) + c + 1] + line;
+        }
+    }
+    auto windowSum = [&](int r, int c) {
+        const int top = std::max(0, r - FairnessRadius), bottom = std::min(rows, r + FairnessRadius + 1);
+        const int left = std::max(0, c - FairnessRadius), right = std::min(cols, c + FairnessRadius + 1);
+        return sums[static_cast<std::size_t>(bottom) * (cols + 1) + right] - sums[static_cast<std::size_t>(top) * (cols + 1) + right] -
+               sums[static_cast<std::size_t>(bottom) * (cols + 1) + left] + sums[static_cast<std::size_t>(top) * (cols + 1) + left];
+    };
+
+    // Where Simulation::findSpawnTiles prefers to put a tribe
+    ComponentLabels landmasses = labelComponents(map, Simulation::isWalkable, Connectivity::Eight);
+    double total = 0.0, totalSquares = 0.0;
+    long long spawns = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (!Simulation::isSpawnTile(map[r][c]) ||
+                landmasses.components[landmasses.at(r, c)].size < Simulation::MinSpawnLandmass) {
+                continue;
+            }
+            const double sum = windowSum(r, c);
+            total += sum;
+            totalSquares += sum * sum;
+            ++spawns;
+        }
+    }
+    if (spawns == 0 || total <= 0.0) return 0.0;
+
+    const double mean = total / static_cast<double>(spawns);
+    const double variance = std::max(0.0, totalSquares / static_cast<double>(spawns) - mean * mean);
+    return std::clamp(1.0 - std::sqrt(variance) / mean, 0.0, 1.0);
+}
+
+double measureMetric(MapMetric metric, const std::vector<std::vector<int>>& map,
+                     const std::vector<std::vector<float>>& fertility) {
+    switch (metric) {
+        case MapMetric::Land: return landFraction(map);
+        case MapMetric::Continents: return continentCount(map);
+        case MapMetric::Rivers: return riverCount(map);
+        case MapMetric::Fairness: return spawnFairness(map, fertility);
+    }
+    return 0.0;
+}
+
+bool MapCriteria::accepts(MapMetric metric, double value) const {
+    const Range& range = ranges[static_cast<int>(metric)];
+    return !range.active || (value >= range.min && value <= range.max);
+}
+
+double MapCriteria::score(const double (&values)[MapMetricCount]) const {
+    if (targets.empty()) return values[static_cast<int>(MapMetric::Fairness)];
+
+    double score = 0.0;
+    for (const Target& target : targets) {
+        double distance = std::abs(values[static_cast<int>(target.metric)] - target.value);
+        if (target.metric == MapMetric::Continents || target.metric == MapMetric::Rivers) {
+            distance /= std::max(1.0, target.value);
+        }
+        score -= target.weight * distance;
+    }
+    return score;
+}
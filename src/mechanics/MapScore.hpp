@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// What players and map designers ask of a map. Each metric is final once a
+// particular generation stage has run (see finalAfter), so a search can drop
+// a map as soon as one of them is out of range.
+enum class MapMetric { Land, Continents, Rivers, Fairness };
+constexpr int MapMetricCount = 4;
+
+// Name used on the command line: land, continents, rivers, fairness
+const char* metricName(MapMetric metric);
+bool parseMetric(const std::string& name, MapMetric& metric);
+// The stage after which later stages no longer change the metric; empty if only
+// the finished map (and its fertility) will do
+const char* finalAfter(MapMetric metric);
+
+// Share of tiles that aren't sea, coast, ocean, ice or lake
+double landFraction(const std::vector<std::vector<int>>& map);
+// Walkable 8-connected landmasses big enough for a tribe to start on
+int continentCount(const std::vector<std::vector<int>>& map);
+// 8-connected river systems (tile 6)
+int riverCount(const std::vector<std::vector<int>>& map);
+// How alike the places a tribe can start are: 1 minus the coefficient of
+// variation of the fertility within FairnessRadius of every spawn tile, 0 if
+// there is nowhere to start
+double spawnFairness(const std::vector<std::vector<int>>& map, const std::vector<std::vector<float>>& fertility);
+constexpr int FairnessRadius = 8;
+
+double measureMetric(MapMetric metric, const std::vector<std::vector<int>>& map,
+                     const std::vector<std::vector<float>>& fertility);
+
+// Hard limits a map must meet, and soft targets that rank the maps that do
+struct MapCriteria {
+    struct Range {
+        bool active = false;
+        double min = 0.0, max = 0.0;
+    };
+    struct Target {
+        MapMetric metric;
+        double value;
+        double weight;
+    };
+    Range ranges[MapMetricCount];
+    std::vector<Target> targets;
+
+    bool accepts(MapMetric metric, double value) const;
+    // Higher is better: minus the weighted distance to each target (continent
+    // and river distances relative to the target). Fairness alone if no targets.
+    double score(const double (&values)[MapMetricCount]) const;
+};
@@ -0,0 +1,123 @@
+#include "MapStats.hpp"
+#include "Components.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static bool isOpenWater(int tile) {
+    return tile == 0 || tile == 22 || tile == 23; // Sea, coast, ocean
+}
+
+MapStats computeMapStats(const std::vector<std::vector<int>>& map) {
+    MapStats stats;
+    const int rows = static_cast<int>(map.size());
+    const int cols = rows > 0 ? static_cast<int>(map[0].size()) : 0;
+
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](std::uint32_t value) {
+        for (int b = 0; b < 4; ++b) {
+            hash ^= (value >> (8 * b)) & 0xFFu;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(static_cast<std::uint32_t>(rows));
+    mix(static_cast<std::uint32_t>(cols));
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            int tile = map[r][c];
+            mix(static_cast<std::uint32_t>(tile));
+            ++stats.histogram[tile];
+            if (tile == 6) ++stats.riverLength;
+
+            // Count each edge once: look right and down only
+            if (c + 1 < cols && isOpenWater(tile) != isOpenWater(map[r][c + 1])) ++stats.coastlineLength;
+            if (r + 1 < rows && isOpenWater(tile) != isOpenWater(map[r + 1][c])) ++stats.coastlineLength;
+        }
+    }
+    stats.hash = hash;
+
+    stats.lakeCount = labelComponents(map, [](int tile) { return tile == 16; }, Connectivity::Eight).components.size();
+
+    return stats;
+}
+
+static bool withinTolerance(long long expected, long long actual) {
+    long long slack = std::max<long long>(3, static_cast<long long>(std::llabs(expected) * 0.10));
+    return std::llabs(expected - actual) <= slack;
+}
+
+GoldenResult compareToGolden(const MapStats& golden, const MapStats& actual, std::string& why) {
+    if (golden.hash == actual.hash) {
+        why.clear();
+        return GoldenResult::Identical;
+    }
+
+    std::ostringstream reasons;
+    long long tiles = 0;
+    for (const auto& [tile, count] : golden.histogram) tiles += count;
+    const long long bucketSlack = std::max<long long>(1, tiles / 100);
+
+    std::map<int, long long> buckets = golden.histogram;
+    for (const auto& [tile, count] : actual.histogram) buckets.emplace(tile, 0);
+    for (const auto& [tile, unused] : buckets) {
+        auto g = golden.histogram.find(tile);
+        auto a = actual.histogram.find(tile);
+        long long expected = g == golden.histogram.end() ? 0 : g->second;
+        long long got = a == actual.histogram.end() ? 0 : a->second;
+        if (std::llabs(expected - got) > bucketSlack) {
+            reasons << " tile " << tile << ": " << expected << " -> " << got << ";";
+        }
+    }
+    if (!withinTolerance(golden.riverLength, actual.riverLength)) {
+        reasons << " river " << golden.riverLength << " -> " << actual.riverLength << ";";
+    }
+    if (!withinTolerance(golden.lakeCount, actual.lakeCount)) {
+        reasons << " lakes " << golden.lakeCount << " -> " << actual.lakeCount << ";";
+    }
+    if (!withinTolerance(golden.coastlineLength, actual.coastlineLength)) {
+        reasons << " coastline " << golden.coastlineLength << " -> " << actual.coastlineLength << ";";
+    }
+
+    why = reasons.str();
+    return why.empty() ? GoldenResult::Equivalent : GoldenResult::Different;
+}
+
+std::vector<GoldenMap> readGoldenFile(const std::string& path) {
+    std::vector<GoldenMap> goldens;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream in(line);
+        GoldenMap golden{};
+        std::string hashText;
+        if (!(in >> golden.seed >> golden.rows >> golden.cols >> hashText >> golden.stats.riverLength
+                 >> golden.stats.lakeCount >> golden.stats.coastlineLength)) {
+            continue;
+        }
+        golden.stats.hash = std::stoull(hashText, nullptr, 16);
+        std::string bucket;
+        while (in >> bucket) {
+            size_t colon = bucket.find(':');
+            if (colon == std::string::npos) continue;
+            golden.stats.histogram[std::stoi(bucket.substr(0, colon))] = std::stoll(bucket.substr(colon + 1));
+        }
+        goldens.push_back(golden);
+    }
+    return goldens;
+}
+
+void writeGoldenLine(std::ostream& out, const GoldenMap& golden) {
+    std::ostringstream hashText;
+    hashText << std::hex << golden.stats.hash;
+    out << golden.seed << " " << golden.rows << " " << golden.cols << " " << hashText.str() << " "
+        << golden.stats.riverLength << " " << golden.stats.lakeCount << " " << golden.stats.coastlineLength;
+    for (const auto& [tile, count] : golden.stats.histogram) {
+        out << " " << tile << ":" << count;
+    }
+    out << "\n";
+}
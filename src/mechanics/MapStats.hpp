@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+// Summary of a generated map, used to check that generator changes keep output
+// identical (hash) or at least statistically equivalent (everything else).
+struct MapStats {
+    std::uint64_t hash = 0;          // FNV-1a over dimensions and every tile
+    std::map<int, long long> histogram;
+    long long riverLength = 0;       // river tiles (6)
+    long long lakeCount = 0;         // 8-connected groups of lake tiles (16)
+    long long coastlineLength = 0;   // 4-neighbour edges between land and open water
+};
+
+MapStats computeMapStats(const std::vector<std::vector<int>>& map);
+
+// One stored reference: generate (seed, rows, cols) and compare against stats
+struct GoldenMap {
+    unsigned int seed;
+    int rows;
+    int cols;
+    MapStats stats;
+};
+
+enum class GoldenResult { Identical, Equivalent, Different };
+
+// Identical if the hash matches. Equivalent if every histogram bucket is within
+// 1% of the tile count and river length, lake count and coastline length are
+// within 10% (with a little absolute slack for small counts).
+GoldenResult compareToGolden(const MapStats& golden, const MapStats& actual, std::string& why);
+
+// Text format, one map per line:
+//   seed rows cols hash river lakes coastline tile:count tile:count ...
+// Lines starting with '#' are comments.
+std::vector<GoldenMap> readGoldenFile(const std::string& path);
+void writeGoldenLine(std::ostream& out, const GoldenMap& golden);
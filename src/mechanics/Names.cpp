@@ -1,30 +1,93 @@
 #include "Names.hpp"
-#include <cstdlib> // For rand() and srand()
-#include <ctime>   // For time() to seed the random number generator
-
-// Constructor: Initialize syllable lists and seed the random number generator
-Names::Names() {
-    // Seed the random number generator
-    std::srand(std::time(0));
-
-    // Populate the syllable lists
-    firstSyllables = {"Ka", "Ta", "Ma", "Sa", "La"};
-    middleSyllables = {"ri", "lo", "me", "na", "si"};
-    lastSyllables = {"neth", "lius", "dor", "vin", "ra"};
-}
-
-// Method to generate a random name
-std::string Names::generateName() {
-    // Combine random syllables from each list
-    std::string name = getRandomSyllable(firstSyllables) +
-                       getRandomSyllable(middleSyllables) +
-                       getRandomSyllable(lastSyllables);
-    return name;
-}
-
-// Helper method to get a random syllable from a list
-std::string Names::getRandomSyllable(const std::vector<std::string>& syllables) {
-    // Generate a random index
-    int index = std::rand() % syllables.size();
-    return syllables[index];
-}
\ No newline at end of file
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+static const std::string_view FirstSyllables[] = {
+    "Ka", "Ta", "Ma", "Sa", "La", "Ba", "Do", "Ge", "Ha", "Ju",
+    "Ko", "Ne", "Or", "Pe", "Ru", "Sho", "Tu", "Va", "Ye", "Za"};
+static const std::string_view MiddleSyllables[] = {
+    "ri", "lo", "me", "na", "si", "ka", "te", "vo", "ru", "an",
+    "el", "mi", "do", "sa", "ne", "ul", "ba", "ti", "go", "er"};
+static const std::string_view LastSyllables[] = {
+    "neth", "lius", "dor", "vin", "ra", "mar", "tok", "wen", "gard", "hul",
+    "sa", "bor", "lin", "dun", "ka", "reth", "mos", "tan", "vek", "ia"};
+
+template <typename Table>
+static std::string_view pick(const Table& table, std::mt19937& rng) {
+    return table[std::uniform_int_distribution<std::size_t>(0, std::size(table) - 1)(rng)];
+}
+
+NameService::NameService(unsigned int seed) : rng(seed) {
+    scratch.reserve(64);
+}
+
+// First + one or two middles + last; with the tables above that is 168,000 names
+void NameService::composeName() {
+    scratch.clear();
+    scratch += pick(FirstSyllables, rng);
+    scratch += pick(MiddleSyllables, rng);
+    if (rng() % 2 == 0) scratch += pick(MiddleSyllables, rng);
+    scratch += pick(LastSyllables, rng);
+}
+
+NameId NameService::generate() {
+    // Retry on collisions; once the tables are crowded, number the name instead
+    for (int attempt = 0; attempt < 32; ++attempt) {
+        composeName();
+        if (lookup.find(scratch) == lookup.end()) return intern(scratch);
+    }
+    std::string base = scratch;
+    for (int suffix = 2;; ++suffix) {
+        scratch = base + " " + std::to_string(suffix);
+        if (lookup.find(scratch) == lookup.end()) return intern(scratch);
+    }
+}
+
+void NameService::generateBulk(std::size_t count, std::vector<NameId>& out) {
+    out.reserve(out.size() + count);
+    names.reserve(names.size() + count);
+    lookup.reserve(lookup.size() + count);
+    for (std::size_t i = 0; i < count; ++i) out.push_back(generate());
+}
+
+// Copies the characters into the arena; blocks are never resized, so views stay valid
+std::string_view NameService::store(std::string_view name) {
+    if (blockUsed + name.size() > BlockSize) {
+        blocks.push_back(std::make_unique<char[]>(std::max(BlockSize, name.size())));
+        blockUsed = 0;
+    }
+    char* destination = blocks.back().get() + blockUsed;
+    std::memcpy(destination, name.data(), name.size());
+    blockUsed += name.size();
+    return std::string_view(destination, name.size());
+}
+
+NameId NameService::intern(std::string_view name) {
+    auto found = lookup.find(name);
+    if (found != lookup.end()) return found->second;
+
+    std::string_view stored = store(name);
+    NameId id = static_cast<NameId>(names.size());
+    names.push_back(stored);
+    lookup.emplace(stored, id);
+    return id;
+}
+
+NameId NameService::find(std::string_view name) const {
+    auto found = lookup.find(name);
+    return found == lookup.end() ? InvalidName : found->second;
+}
+
+std::string_view NameService::get(NameId id) const {
+    return id < names.size() ? names[id] : std::string_view();
+}
+
+std::size_t NameService::size() const {
+    return names.size();
+}
+
+std::size_t NameService::arenaBytes() const {
+    return blocks.size() * BlockSize;
+}
@@ -1,25 +1,49 @@
-#ifndef NAMES_HPP
-#define NAMES_HPP
+#pragma once
 
+#include <cstdint>
+#include <memory>
+#include <random>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
-class Names {
+using NameId = std::uint32_t;
+
+// Generates unique names from syllable tables and keeps them interned: the
+// characters live in an arena of fixed-size blocks that never move, entities
+// hold a 32-bit NameId, and looking a name up by id or by text is O(1).
+// Same seed, same names in the same order.
+class NameService {
 public:
-    // Constructor
-    Names();
+    explicit NameService(unsigned int seed);
+
+    // A name not handed out before
+    NameId generate();
+    // Appends `count` new unique names to `out`, reserving space once up front
+    void generateBulk(std::size_t count, std::vector<NameId>& out);
+
+    // Id of an existing name, adding it if it's new
+    NameId intern(std::string_view name);
+    NameId find(std::string_view name) const; // InvalidName if unknown
+    std::string_view get(NameId id) const;
+
+    std::size_t size() const;
+    std::size_t arenaBytes() const;
 
-    // Method to generate a name
-    std::string generateName();
+    static constexpr NameId InvalidName = 0xFFFFFFFFu;
 
 private:
-    // Lists of syllables
-    std::vector<std::string> firstSyllables;
-    std::vector<std::string> middleSyllables;
-    std::vector<std::string> lastSyllables;
+    void composeName();
+    std::string_view store(std::string_view name);
 
-    // Helper method to get a random syllable from a list
-    std::string getRandomSyllable(const std::vector<std::string>& syllables);
-};
+    std::mt19937 rng;
+    std::string scratch; // reused for every name composed
+
+    static constexpr std::size_t BlockSize = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t blockUsed = BlockSize;
 
-#endif // NAMES_HPP
\ No newline at end of file
+    std::vector<std::string_view> names;                  // indexed by NameId, views into the arena
+    std::unordered_map<std::string_view, NameId> lookup;  // same views, for uniqueness and find()
+};
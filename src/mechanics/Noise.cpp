@@ -0,0 +1,252 @@
+#include "Noise.hpp"
+#include "../Tools/ParallelFor.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+
+static const int ChunkSize = 64;
+static const int WarpStep = 8;
+
+// A portable x86 build only assumes SSE2, four floats per instruction. GCC and
+// Clang can also build the chunk sampler for AVX2 (eight) and pick it at run
+// time on CPUs that have it. Without FMA contraction both give the same values.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(__AVX2__)
+#define GRIDGAME_NOISE_AVX2_DISPATCH
+static bool cpuHasAvx2() {
+    __builtin_cpu_init(); // static initialisers may run before the compiler's own CPU probe
+    return __builtin_cpu_supports("avx2");
+}
+static const bool UseAvx2 = cpuHasAvx2();
+#endif
+
+// Skew to and from the simplex (triangle) lattice
+static const float F2 = 0.36602540378f; // (sqrt(3) - 1) / 2
+static const float G2 = 0.21132486540f; // (3 - sqrt(3)) / 6
+// Brings the sum of the three corners back to about [-1, 1]
+static const float SimplexScale = 45.f;
+
+GradientNoise::GradientNoise(unsigned int seed) : seed(seed) {}
+
+// Integer hash of a lattice point. One multiply round: 32-bit vector multiplies
+// are slow before SSE4.1, and the gradient only needs the well-mixed top bits.
+static inline std::uint32_t hashPoint(std::uint32_t base, std::int32_t i, std::int32_t j) {
+    std::uint32_t h = base ^ (static_cast<std::uint32_t>(i) * 0x85EBCA6Bu) ^ (static_cast<std::uint32_t>(j) * 0xC2B2AE35u);
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    return h >> 29;
+}
+
+// Contribution of one corner: one of eight gradients (+-1, +-2) / (+-2, +-1)
+// picked by the three hash bits, attenuated by (0.5 - r^2)^4
+static inline float corner(std::uint32_t h, float x, float y) {
+    // Signed conversions: unsigned to float has no single instruction before AVX-512
+    const float a = 1.f + static_cast<float>(static_cast<std::int32_t>(h & 1u));
+    const float b = 3.f - a;
+    const float sx = 1.f - static_cast<float>(static_cast<std::int32_t>(h & 2u));
+    const float sy = 1.f - static_cast<float>(static_cast<std::int32_t>((h >> 1) & 2u));
+    float t = 0.5f - x * x - y * y;
+    t = 0.5f * (t + std::fabs(t)); // max(t, 0) without a compare the vectoriser has to keep as a branch
+    t *= t;
+    return t * t * (sx * a * x + sy * b * y);
+}
+
+// Floor that stays in plain compares so it vectorises without SSE4.1
+static inline std::int32_t fastFloor(float v) {
+    std::int32_t i = static_cast<std::int32_t>(v);
+    return i - static_cast<std::int32_t>(v < static_cast<float>(i));
+}
+
+void GradientNoise::simplex8(const float* x, const float* y, std::uint32_t stream, float* out) const {
+    const std::uint32_t base = seed ^ (stream * 0x9E3779B9u);
+    for (int k = 0; k < Batch; ++k) {
+        // Which simplex cell, and where in it
+        const float s = (x[k] + y[k]) * F2;
+        const std::int32_t i = fastFloor(x[k] + s);
+        const std::int32_t j = fastFloor(y[k] + s);
+        const float t = static_cast<float>(i + j) * G2;
+        const float x0 = x[k] - (static_cast<float>(i) - t);
+        const float y0 = y[k] - (static_cast<float>(j) - t);
+
+        // Lower or upper triangle decides the middle corner
+        const std::int32_t i1 = static_cast<std::int32_t>(x0 > y0);
+        const std::int32_t j1 = 1 - i1;
+        const float x1 = x0 - static_cast<float>(i1) + G2;
+        const float y1 = y0 - static_cast<float>(j1) + G2;
+        const float x2 = x0 - 1.f + 2.f * G2;
+        const float y2 = y0 - 1.f + 2.f * G2;
+
+        const float n = corner(hashPoint(base, i, j), x0, y0) + corner(hashPoint(base, i + i1, j + j1), x1, y1) +
+                        corner(hashPoint(base, i + 1, j + 1), x2, y2);
+        out[k] = SimplexScale * n;
+    }
+}
+
+void GradientNoise::fractal8(const float* x, const float* y, std::uint32_t stream, int octaves, float lacunarity,
+                             float gain, float* out) const {
+    float px[Batch], py[Batch], octave[Batch];
+    for (int k = 0; k < Batch; ++k) {
+        px[k] = x[k];
+        py[k] = y[k];
+        out[k] = 0.f;
+    }
+
+    float amplitude = 1.f;
+    float total = 0.f;
+    for (int o = 0; o < octaves; ++o) {
+        simplex8(px, py, stream + static_cast<std::uint32_t>(o), octave);
+        for (int k = 0; k < Batch; ++k) {
+            out[k] += amplitude * octave[k];
+            px[k] *= lacunarity;
+            py[k] *= lacunarity;
+        }
+        total += amplitude;
+        amplitude *= gain;
+    }
+
+    const float norm = total > 0.f ? 1.f / total : 0.f;
+    for (int k = 0; k < Batch; ++k) out[k] *= norm;
+}
+
+static inline void sampleChunkBody(const GradientNoise& noise, int rowBegin, int colBegin, int rows, int cols,
+                                   const NoiseSettings& settings, float* out, int stride) {
+    const int Batch = GradientNoise::Batch;
+    // Separate streams for the height and the two warp axes
+    const std::uint32_t heightStream = 0, warpXStream = 1000, warpYStream = 2000;
+    const bool warped = settings.warpStrength > 0.f;
+
+    // The warp field is smooth, so it is sampled on a coarse lattice (every
+    // WarpStep tiles, in map coordinates so chunks agree) and interpolated
+    const int latticeRow = rowBegin / WarpStep, latticeCol = colBegin / WarpStep;
+    const int latticeRows = (rowBegin + rows - 1) / WarpStep - latticeRow + 2;
+    const int latticeCols = (colBegin + cols - 1) / WarpStep - latticeCol + 2;
+    const int latticeCount = latticeRows * latticeCols;
+    // A full-size chunk's lattice fits on the stack; anything bigger spills to the heap
+    alignas(std::max_align_t) char latticeBuffer[2048];
+    std::pmr::monotonic_buffer_resource latticeMemory(latticeBuffer, sizeof latticeBuffer);
+    std::pmr::vector<float> warpX(&latticeMemory), warpY(&latticeMemory);
+    if (warped) {
+        warpX.resize(latticeCount + Batch);
+        warpY.resize(latticeCount + Batch);
+        float px[Batch], py[Batch];
+        for (int n = 0; n < latticeCount; n += Batch) {
+            for (int k = 0; k < Batch; ++k) {
+                const int index = std::min(n + k, latticeCount - 1);
+                px[k] = static_cast<float>((latticeCol + index % latticeCols) * WarpStep) * settings.warpFrequency;
+                py[k] = static_cast<float>((latticeRow + index / latticeCols) * WarpStep) * settings.warpFrequency;
+            }
+            noise.fractal8(px, py, warpXStream, settings.warpOctaves, settings.lacunarity, settings.gain, &warpX[n]);
+            noise.fractal8(px, py, warpYStream, settings.warpOctaves, settings.lacunarity, settings.gain, &warpY[n]);
+        }
+    }
+
+    float tx[Batch], ty[Batch], px[Batch], py[Batch], height[Batch];
+    for (int r = 0; r < rows; ++r) {
+        const int row = rowBegin + r;
+        const int cellRow = row / WarpStep - latticeRow;
+        const float fy = static_cast<float>(row % WarpStep) / WarpStep;
+        for (int c = 0; c < cols; c += Batch) {
+            for (int k = 0; k < Batch; ++k) {
+                tx[k] = static_cast<float>(colBegin + c + k);
+                ty[k] = static_cast<float>(row);
+            }
+
+            // Push the sample point around by a second, low frequency field
+            if (warped) {
+                for (int k = 0; k < Batch; ++k) {
+                    const int col = std::min(colBegin + c + k, colBegin + cols - 1);
+                    const int cell = cellRow * latticeCols + col / WarpStep - latticeCol;
+                    const float fx = static_cast<float>(col % WarpStep) / WarpStep;
+                    auto lerp2 = [&](const std::pmr::vector<float>& w) {
+                        const float top = w[cell] + (w[cell + 1] - w[cell]) * fx;
+                        const float bottom = w[cell + latticeCols] + (w[cell + latticeCols + 1] - w[cell + latticeCols]) * fx;
+                        return top + (bottom - top) * fy;
+                    };
+                    tx[k] += settings.warpStrength * lerp2(warpX);
+                    ty[k] += settings.warpStrength * lerp2(warpY);
+                }
+            }
+
+            for (int k = 0; k < Batch; ++k) {
+                px[k] = tx[k] * settings.frequency;
+                py[k] = ty[k] * settings.frequency;
+            }
+            noise.fractal8(px, py, heightStream, settings.octaves, settings.lacunarity, settings.gain, height);
+
+            float* line = out + static_cast<std::size_t>(r) * stride + c;
+            const int count = std::min(Batch, cols - c);
+            for (int k = 0; k < count; ++k) line[k] = height[k];
+        }
+    }
+}
+
+#ifdef GRIDGAME_NOISE_AVX2_DISPATCH
+// flatten pulls fractal8 and simplex8 in, so the whole kernel is built for AVX2
+__attribute__((target("avx2"), flatten))
+static void sampleChunkAvx2(const GradientNoise& noise, int rowBegin, int colBegin, int rows, int cols,
+                            const NoiseSettings& settings, float* out, int stride) {
+    sampleChunkBody(noise, rowBegin, colBegin, rows, cols, settings, out, stride);
+}
+#endif
+
+void GradientNoise::sampleChunk(int rowBegin, int colBegin, int rows, int cols, const NoiseSettings& settings,
+                                float* out, int stride) const {
+#ifdef GRIDGAME_NOISE_AVX2_DISPATCH
+    if (UseAvx2) {
+        sampleChunkAvx2(*this, rowBegin, colBegin, rows, cols, settings, out, stride);
+        return;
+    }
+#endif
+    sampleChunkBody(*this, rowBegin, colBegin, rows, cols, settings, out, stride);
+}
+
+std::vector<float> generateHeightfield(int rows, int cols, unsigned int seed, const NoiseSettings& settings,
+                                       int threads) {
+    std::vector<float> field(static_cast<std::size_t>(std::max(rows, 0)) * std::max(cols, 0));
+    generateHeightfield(field, rows, cols, seed, settings, threads);
+    return field;
+}
+
+void generateHeightfield(std::span<float> field, int rows, int cols, unsigned int seed, const NoiseSettings& settings,
+                         int threads, const std::atomic<bool>* cancel) {
+    PROFILE_SCOPE("generateHeightfield");
+    if (rows <= 0 || cols <= 0) return;
+
+    const GradientNoise noise(seed);
+    const int chunkRows = (rows + ChunkSize - 1) / ChunkSize;
+    const int chunkCols = (cols + ChunkSize - 1) / ChunkSize;
+    parallelFor(chunkRows * chunkCols, threads, [&](int chunk) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) return;
+        const int rowBegin = (chunk / chunkCols) * ChunkSize;
+        const int colBegin = (chunk % chunkCols) * ChunkSize;
+        noise.sampleChunk(rowBegin, colBegin, std::min(ChunkSize, rows - rowBegin), std::min(ChunkSize, cols - colBegin),
+                          settings, &field[static_cast<std::size_t>(rowBegin) * cols + colBegin], cols);
+    });
+}
+
+std::pmr::vector<float> heightQuantiles(std::span<const float> field, std::span<const float> fractions,
+                                        std::pmr::memory_resource* resource) {
+    std::pmr::vector<float> thresholds(fractions.size(), 0.f, resource);
+    if (field.empty()) return thresholds;
+
+    auto [lowest, highest] = std::minmax_element(field.begin(), field.end());
+    const float low = *lowest;
+    const float width = (*highest - low) / 4096.f;
+    if (width <= 0.f) {
+        std::fill(thresholds.begin(), thresholds.end(), low);
+        return thresholds;
+    }
+
+    std::pmr::vector<long long> histogram(4096, 0, resource);
+    for (float v : field) ++histogram[std::min(4095, static_cast<int>((v - low) / width))];
+
+    long long below = 0;
+    int bin = 0;
+    for (std::size_t i = 0; i < fractions.size(); ++i) {
+        const double wanted = static_cast<double>(fractions[i]) * static_cast<double>(field.size());
+        while (bin < 4096 && below + histogram[bin] <= wanted) below += histogram[bin++];
+        thresholds[i] = low + static_cast<float>(bin) * width;
+    }
+    return thresholds;
+}
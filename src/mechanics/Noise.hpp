@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+struct NoiseSettings {
+    float frequency = 1.f / 128.f;   // base octave, in cycles per tile
+    int octaves = 6;
+    float lacunarity = 2.f;          // frequency step between octaves
+    float gain = 0.5f;               // amplitude step between octaves
+    float warpStrength = 24.f;       // domain warp offset in tiles, 0 = off
+    float warpFrequency = 1.f / 256.f;
+    int warpOctaves = 2;
+};
+
+// 2D simplex gradient noise. Gradients come from hashing the lattice point with
+// the seed rather than from a permutation table, so there are no lookups and
+// every step of an 8-point batch is plain arithmetic the compiler can vectorise.
+class GradientNoise {
+public:
+    static constexpr int Batch = 8;
+
+    explicit GradientNoise(unsigned int seed);
+
+    // Noise at 8 points, roughly in [-1, 1]. `stream` picks an independent field.
+    void simplex8(const float* x, const float* y, std::uint32_t stream, float* out) const;
+    // Sum of octaves, normalised back to roughly [-1, 1]
+    void fractal8(const float* x, const float* y, std::uint32_t stream, int octaves, float lacunarity,
+                  float gain, float* out) const;
+
+    // Domain-warped fractal height for the tiles [rowBegin, rowBegin + rows) x
+    // [colBegin, colBegin + cols), written with `stride` floats between rows.
+    // Values only depend on the tile coordinates, so chunks made separately
+    // (on different threads, or later) meet without seams.
+    void sampleChunk(int rowBegin, int colBegin, int rows, int cols, const NoiseSettings& settings, float* out,
+                     int stride) const;
+
+private:
+    std::uint32_t seed;
+};
+
+// Whole-map heightfield, row-major, generated in 64x64 chunks over `threads`
+// threads (0 = one per core). The result doesn't depend on the thread count.
+std::vector<float> generateHeightfield(int rows, int cols, unsigned int seed, const NoiseSettings& settings = {},
+                                       int threads = 0);
+// The same written into `field`, which must hold rows * cols values. Chunks not
+// yet started are skipped once `cancel` (may be null) is set, leaving the field
+// unfinished.
+void generateHeightfield(std::span<float> field, int rows, int cols, unsigned int seed,
+                         const NoiseSettings& settings = {}, int threads = 0,
+                         const std::atomic<bool>* cancel = nullptr);
+
+// The values below which the given fractions of the field lie, from a
+// histogram. `fractions` must be increasing. The result and the histogram
+// come from `resource`.
+std::pmr::vector<float> heightQuantiles(std::span<const float> field, std::span<const float> fractions,
+                                        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
@@ -0,0 +1,294 @@
+#include "Simulation.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <tuple>
+
+static long long steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Simulation::Simulation(const std::vector<std::vector<int>>& map, const FertilityMap& fertility, unsigned int seed,
+                       int aiTribes)
+    : map(map),
+      rows(static_cast<int>(map.size())),
+      cols(map.empty() ? 0 : static_cast<int>(map[0].size())),
+      landmasses(labelComponents(map, isWalkable, Connectivity::Eight)),
+      rng(seed),
+      names(seed + 2),
+      villages(rows, cols, fertility.getFertilityGrid()),
+      villageRng(seed + 1),
+      territory(rows, cols),
+      fog(rows, cols) {
+    findSpawnTiles();
+    if (spawnTiles.empty()) std::cerr << "No walkable tile to start tribes on; they are left at 0,0\n";
+    spawnTribe(false);
+    for (int i = 0; i < aiTribes; ++i) spawnTribe(true);
+
+    fog.revealRadius(tribes[0].row, tribes[0].col, PlayerSightRadius);
+    publish();
+}
+
+Simulation::~Simulation() {
+    stop();
+}
+
+bool Simulation::isWalkable(int tileType) {
+    switch (tileType) {
+        case 0:  // Sea
+        case 3:  // Mountain
+        case 7:  // Ice
+        case 15: // Ice cap
+        case 16: // Lake
+        case 22: // Coast
+        case 23: // Ocean
+            return false;
+        default:
+            return true;
+    }
+}
+
+// Tribes start on grassland, hills, forest or jungle
+bool Simulation::isSpawnTile(int tileType) {
+    return tileType == 1 || tileType == 2 || tileType == 18 || tileType == 20;
+}
+
+// Spawn tiles on a large enough landmass; on a map of nothing but small islands,
+// any walkable tile rather than none
+void Simulation::findSpawnTiles() {
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (isSpawnTile(map[r][c]) && landmasses.components[landmasses.at(r, c)].size >= MinSpawnLandmass) {
+                spawnTiles.push_back({r, c});
+            }
+        }
+    }
+    if (!spawnTiles.empty()) return;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (isWalkable(map[r][c])) spawnTiles.push_back({r, c});
+        }
+    }
+}
+
+void Simulation::spawnTribe(bool ai) {
+    TribeState tribe{static_cast<int>(tribes.size()), 0, 0, 0, 0, ai, names.generate()};
+    if (!spawnTiles.empty()) {
+        std::uniform_int_distribution<std::size_t> pick(0, spawnTiles.size() - 1);
+        std::tie(tribe.row, tribe.col) = spawnTiles[pick(rng)];
+    }
+    tribe.previousRow = tribe.row;
+    tribe.previousCol = tribe.col;
+    tribes.push_back(tribe);
+}
+
+void Simulation::setTickRate(double ticksPerSecond) {
+    tickSeconds = ticksPerSecond > 0.0 ? 1.0 / ticksPerSecond : 0.0;
+}
+
+void Simulation::setPlayerAutomated(bool automated) {
+    playerAutomated = automated;
+}
+
+void Simulation::setVillageThreads(int threads) {
+    villageThreads = threads;
+}
+
+void Simulation::start() {
+    stop();
+    stopRequested = false;
+    worker = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop() {
+    stopRequested = true;
+    if (worker.joinable()) worker.join();
+}
+
+void Simulation::run() {
+    Profiler::setThreadName("simulation");
+    auto next = std::chrono::steady_clock::now();
+    const auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(tickSeconds));
+
+    while (!stopRequested) {
+        tick(true);
+        if (tickSeconds <= 0.0) continue;
+
+        // Keep a steady rate; after a stall, resume from now instead of catching up
+        next += step;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now - 4 * step) next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void Simulation::step() {
+    tick(false);
+}
+
+void Simulation::tick(bool publishSnapshot) {
+    PROFILE_SCOPE("Simulation::tick");
+
+    for (TribeState& tribe : tribes) {
+        tribe.previousRow = tribe.row;
+        tribe.previousCol = tribe.col;
+    }
+
+    SimCommand command;
+    while (commands.pop(command)) {
+        if (command.tribe < 0 || command.tribe >= static_cast<int>(tribes.size())) continue;
+        if (command.type == SimCommand::MoveTribe) {
+            moveTribe(tribes[command.tribe], command.row, command.col);
+        } else if (command.type == SimCommand::FoundVillage) {
+            foundVillage(tribes[command.tribe]);
+        }
+    }
+
+    // AI tribes wander one tile in a random direction when they can
+    std::uniform_int_distribution<> direction(0, 7);
+    static const int offsets[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+    for (TribeState& tribe : tribes) {
+        if (!tribe.ai && !playerAutomated) continue;
+        const int* offset = offsets[direction(rng)];
+        moveTribe(tribe, tribe.row + offset[0], tribe.col + offset[1]);
+    }
+
+    std::uniform_int_distribution<> founding(0, AiFoundingChance - 1);
+    for (const TribeState& tribe : tribes) {
+        if (!tribe.ai && !playerAutomated) continue;
+        if (founding(villageRng) == 0) foundVillage(tribe);
+    }
+    villages.updateTurn(villageThreads);
+    syncTerritory();
+
+    ++tickCount;
+    if (publishSnapshot) publish();
+}
+
+void Simulation::foundVillage(const TribeState& tribe) {
+    if (!isWalkable(map[tribe.row][tribe.col])) return;
+    int village = villages.found(tribe.row, tribe.col, tribe.id);
+    if (village != -1) villages.setName(village, names.generate());
+}
+
+// Copies the tiles villages claimed or released this tick into the territory layer
+void Simulation::syncTerritory() {
+    const std::vector<int>& changed = villages.getChangedTiles();
+    if (changed.empty()) return;
+
+    const std::vector<int>& owners = villages.getOwnerGrid();
+    for (int index : changed) {
+        int village = owners[index];
+        territory.setOwner(index / cols, index % cols, village == -1 ? -1 : villages.getTribes()[village]);
+    }
+    villages.clearChangedTiles();
+    territoryChanged = true;
+}
+
+void Simulation::moveTribe(TribeState& tribe, int row, int col) {
+    if (row < 0 || row >= rows || col < 0 || col >= cols || !isWalkable(map[row][col])) return;
+
+    if (tribe.id == 0) {
+        // Only the area revealed from the old position can be visible
+        fog.markSeenRadius(tribe.row, tribe.col, PlayerSightRadius);
+        fog.revealRadius(row, col, PlayerSightRadius);
+        fogChanged = true;
+    }
+
+    tribe.row = row;
+    tribe.col = col;
+}
+
+// A shared copy of `source` for a snapshot. The fog is copied on most ticks, so
+// instead of a fresh allocation each time, a copy that only `copies` still
+// holds (no snapshot slot, no reader) is overwritten in place.
+template <typename T>
+static std::shared_ptr<const T> recycledCopy(std::vector<std::shared_ptr<T>>& copies, const T& source) {
+    for (const std::shared_ptr<T>& copy : copies) {
+        if (copy.use_count() != 1) continue;
+        // Pairs with the reader dropping its last reference, so its reads are done
+        std::atomic_thread_fence(std::memory_order_acquire);
+        *copy = source;
+        return copy;
+    }
+    copies.push_back(std::make_shared<T>(source));
+    return copies.back();
+}
+
+void Simulation::publish() {
+    if (fogChanged) {
+        publishedFog = recycledCopy(fogCopies, fog);
+        fogChanged = false;
+    }
+    if (territoryChanged) {
+        publishedTerritory = recycledCopy(territoryCopies, territory);
+        territoryChanged = false;
+    }
+
+    WorldSnapshot& snapshot = snapshots.back();
+    snapshot.tick = tickCount;
+    snapshot.tickSeconds = tickSeconds;
+    snapshot.publishedNs = steadyNowNs();
+    snapshot.tribes = tribes; // reuses the slot's capacity
+    snapshot.villages.clear();
+    for (int id = 0; id < villages.getCount(); ++id) {
+        if (!villages.isAlive(id)) continue;
+        snapshot.villages.push_back({id, villages.getRows()[id], villages.getCols()[id], villages.getTribes()[id],
+                                     villages.getNames()[id], villages.getPopulations()[id]});
+    }
+    snapshot.fog = publishedFog;
+    snapshot.territory = publishedTerritory;
+    snapshots.publish();
+}
+
+bool Simulation::post(const SimCommand& command) {
+    return commands.push(command);
+}
+
+const WorldSnapshot& Simulation::latestSnapshot() {
+    snapshots.acquire();
+    return snapshots.front();
+}
+
+float Simulation::interpolation(const WorldSnapshot& snapshot) {
+    if (snapshot.tickSeconds <= 0.0) return 1.0f;
+    double elapsed = (steadyNowNs() - snapshot.publishedNs) / 1e9;
+    return static_cast<float>(std::clamp(elapsed / snapshot.tickSeconds, 0.0, 1.0));
+}
+
+long long Simulation::getTick() const {
+    return tickCount;
+}
+
+const std::vector<TribeState>& Simulation::getTribes() const {
+    return tribes;
+}
+
+const FogOfWarMap& Simulation::getFog() const {
+    return fog;
+}
+
+const VillageSystem& Simulation::getVillages() const {
+    return villages;
+}
+
+const TerritoryMap& Simulation::getTerritory() const {
+    return territory;
+}
+
+const NameService& Simulation::getNames() const {
+    return names;
+}
+
+const ComponentLabels& Simulation::getLandmasses() const {
+    return landmasses;
+}
+
+bool Simulation::hasSpawnTiles() const {
+    return !spawnTiles.empty();
+}
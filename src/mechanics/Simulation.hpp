@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Components.hpp"
+#include "FoW.hpp"
+#include "Territory.hpp"
+#include "Fertility.hpp"
+#include "Names.hpp"
+#include "Village.hpp"
+#include "../Tools/SpscQueue.hpp"
+#include "../Tools/TripleBuffer.hpp"
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct TribeState {
+    int id;
+    int row;
+    int col;
+    int previousRow;   // position one tick earlier, for interpolation
+    int previousCol;
+    bool ai;
+    NameId name;
+};
+
+struct VillageState {
+    int id;
+    int row;
+    int col;
+    int tribe;
+    NameId name;
+    float population;
+};
+
+// Immutable picture of the world after a tick. The fog is shared between
+// snapshots and only copied when a tick changes it.
+struct WorldSnapshot {
+    long long tick = 0;
+    double tickSeconds = 0.0;     // timestep in use, 0 when running flat out
+    long long publishedNs = 0;    // steady clock time the tick finished
+    std::vector<TribeState> tribes;
+    std::vector<VillageState> villages; // living ones only
+    std::shared_ptr<const FogOfWarMap> fog;
+    std::shared_ptr<const TerritoryMap> territory; // shared like the fog
+};
+
+struct SimCommand {
+    enum Type { MoveTribe, FoundVillage }; // FoundVillage settles where the tribe stands
+    Type type;
+    int tribe;
+    int row;
+    int col;
+};
+
+// Game state advanced in fixed ticks. Either run it on its own thread with
+// start(), where the renderer reads snapshots and posts commands without ever
+// blocking, or drive it directly with step() (headless runs).
+//
+// Tribe 0 is the player's; the fog is what the player's tribe has seen. The rest
+// are AI tribes that wander over land and now and then found a village.
+class Simulation {
+public:
+    Simulation(const std::vector<std::vector<int>>& map, const FertilityMap& fertility, unsigned int seed, int aiTribes);
+    ~Simulation();
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Ticks per second of simulated time; 0 runs ticks back to back. Set before start().
+    void setTickRate(double ticksPerSecond);
+    // Lets the player's tribe wander like the AI ones (AI-only soak runs)
+    void setPlayerAutomated(bool automated);
+    // Threads for the village update (0 = one per core); 1 keeps it on the tick thread
+    void setVillageThreads(int threads);
+    void start();
+    void stop();
+
+    // Runs one tick on the calling thread; don't combine with start(). No snapshot
+    // is published: read getTribes()/getFog() instead.
+    void step();
+
+    // Render thread side. post() returns false if the command queue is full.
+    bool post(const SimCommand& command);
+    const WorldSnapshot& latestSnapshot();
+    // How far (0..1) the present is between the snapshot's previous and current positions
+    static float interpolation(const WorldSnapshot& snapshot);
+
+    // Simulation thread (or headless caller) side
+    long long getTick() const;
+    const std::vector<TribeState>& getTribes() const;
+    const FogOfWarMap& getFog() const;
+    const VillageSystem& getVillages() const;
+    const TerritoryMap& getTerritory() const;
+    // Grows as tribes and villages are named; safe to read from other threads only before start()
+    const NameService& getNames() const;
+    // Walkable landmasses (8-connected), labelled once at construction
+    const ComponentLabels& getLandmasses() const;
+    // False when the map has no walkable tile at all; every tribe then stands at 0,0
+    bool hasSpawnTiles() const;
+
+    static bool isWalkable(int tileType);
+    static bool isSpawnTile(int tileType); // grassland, hills, forest or jungle
+    static constexpr int PlayerSightRadius = 8;
+    static constexpr int MinSpawnLandmass = 64; // tribes don't start on islands smaller than this
+    static constexpr int AiFoundingChance = 64; // an AI tribe settles on about 1 tick in this many
+
+private:
+    void run();
+    void tick(bool publishSnapshot);
+    void publish();
+    void moveTribe(TribeState& tribe, int row, int col);
+    void findSpawnTiles();
+    void spawnTribe(bool ai);
+    void foundVillage(const TribeState& tribe);
+    void syncTerritory();
+
+    std::vector<std::vector<int>> map;
+    int rows, cols;
+    ComponentLabels landmasses;
+    std::vector<std::pair<int, int>> spawnTiles; // where spawnTribe picks from, found once
+    std::mt19937 rng;
+    std::vector<TribeState> tribes;
+    NameService names;
+    long long tickCount = 0;
+    double tickSeconds = 0.25;
+    bool playerAutomated = false;
+
+    VillageSystem villages;
+    std::mt19937 villageRng; // separate so settling doesn't change how tribes wander
+    int villageThreads = 1;
+
+    // Village claims rolled up to the tribe that founded each village
+    TerritoryMap territory;
+    std::shared_ptr<const TerritoryMap> publishedTerritory;
+    std::vector<std::shared_ptr<TerritoryMap>> territoryCopies; // every copy published so far, reused once released
+    bool territoryChanged = true;
+
+    FogOfWarMap fog;
+    std::shared_ptr<const FogOfWarMap> publishedFog;
+    std::vector<std::shared_ptr<FogOfWarMap>> fogCopies; // every copy published so far, reused once released
+    bool fogChanged = true;
+
+    SpscQueue<SimCommand, 256> commands;
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::thread worker;
+    std::atomic<bool> stopRequested{false};
+};
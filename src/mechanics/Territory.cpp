@@ -0,0 +1,59 @@
+#include "Territory.hpp"
+
+TerritoryMap::TerritoryMap(int rows, int cols)
+    : rows(rows),
+      cols(cols),
+      chunkRows((rows + ChunkSize - 1) / ChunkSize),
+      chunkCols((cols + ChunkSize - 1) / ChunkSize),
+      owner(rows * cols, -1),
+      borders(rows * cols, 0),
+      chunkVersion(chunkRows * chunkCols, 0) {}
+
+void TerritoryMap::setOwner(int row, int col, int newOwner) {
+    if (row < 0 || row >= rows || col < 0 || col >= cols) return;
+    if (owner[row * cols + col] == newOwner) return;
+    owner[row * cols + col] = newOwner;
+
+    // Only this tile and the ones sharing an edge with it can have new borders
+    updateBorders(row, col);
+    updateBorders(row - 1, col);
+    updateBorders(row + 1, col);
+    updateBorders(row, col - 1);
+    updateBorders(row, col + 1);
+}
+
+void TerritoryMap::updateBorders(int row, int col) {
+    if (row < 0 || row >= rows || col < 0 || col >= cols) return;
+
+    const int self = owner[row * cols + col];
+    std::uint8_t mask = 0;
+    if (self != -1) {
+        if (getOwner(row - 1, col) != self) mask |= North;
+        if (getOwner(row, col + 1) != self) mask |= East;
+        if (getOwner(row + 1, col) != self) mask |= South;
+        if (getOwner(row, col - 1) != self) mask |= West;
+    }
+
+    if (borders[row * cols + col] == mask) return;
+    borders[row * cols + col] = mask;
+    ++chunkVersion[(row / ChunkSize) * chunkCols + col / ChunkSize];
+}
+
+int TerritoryMap::getOwner(int row, int col) const {
+    if (row < 0 || row >= rows || col < 0 || col >= cols) return -1;
+    return owner[row * cols + col];
+}
+
+std::uint8_t TerritoryMap::getBorders(int row, int col) const {
+    if (row < 0 || row >= rows || col < 0 || col >= cols) return 0;
+    return borders[row * cols + col];
+}
+
+int TerritoryMap::getRows() const { return rows; }
+int TerritoryMap::getCols() const { return cols; }
+int TerritoryMap::getChunkRows() const { return chunkRows; }
+int TerritoryMap::getChunkCols() const { return chunkCols; }
+
+std::uint32_t TerritoryMap::getChunkVersion(int chunkRow, int chunkCol) const {
+    return chunkVersion[chunkRow * chunkCols + chunkCol];
+}
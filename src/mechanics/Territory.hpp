@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Which tribe owns each tile, plus the borders that ownership implies.
+//
+// Every tile keeps a mask of the edges where its owner differs from the tile
+// across the edge. setOwner only re-evaluates the changed tile and its four
+// neighbours, and bumps the version of any chunk whose masks changed, so a
+// renderer can rebuild just those chunks by comparing versions.
+class TerritoryMap {
+public:
+    TerritoryMap(int rows, int cols);
+
+    enum Edge : std::uint8_t { North = 1, East = 2, South = 4, West = 8 };
+    static constexpr int ChunkSize = 32; // tiles per chunk side
+
+    // owner is a tribe id, or -1 to release the tile
+    void setOwner(int row, int col, int owner);
+    int getOwner(int row, int col) const; // -1 if unclaimed or off the map
+    // Edges of an owned tile that face another owner, unclaimed land or the map edge
+    std::uint8_t getBorders(int row, int col) const;
+
+    int getRows() const;
+    int getCols() const;
+    int getChunkRows() const;
+    int getChunkCols() const;
+    // Changes whenever a border inside the chunk changes
+    std::uint32_t getChunkVersion(int chunkRow, int chunkCol) const;
+
+private:
+    void updateBorders(int row, int col);
+
+    int rows, cols;
+    int chunkRows, chunkCols;
+    std::vector<int> owner;              // row-major, -1 = unclaimed
+    std::vector<std::uint8_t> borders;   // row-major Edge masks
+    std::vector<std::uint32_t> chunkVersion;
+};
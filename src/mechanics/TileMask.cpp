@@ -0,0 +1,165 @@
+#include "TileMask.hpp"
+
+#include <algorithm>
+
+TileMask::TileMask(int rows, int cols, bool value, std::pmr::memory_resource* resource)
+    : rows(rows), cols(cols), wordsPerRow((cols + 63) / 64),
+      words(static_cast<std::size_t>(rows) * ((cols + 63) / 64), 0, resource) {
+    if (value) invert();
+}
+
+TileMask::TileMask(const TileMask& other, std::pmr::memory_resource* resource)
+    : rows(other.rows), cols(other.cols), wordsPerRow(other.wordsPerRow), words(other.words, resource) {}
+
+TileMask TileMask::rowBand(int rows, int cols, int rowBegin, int rowEnd, std::pmr::memory_resource* resource) {
+    TileMask mask(rows, cols, false, resource);
+    rowBegin = std::max(rowBegin, 0);
+    rowEnd = std::min(rowEnd, rows);
+    for (int r = rowBegin; r < rowEnd; ++r) {
+        for (int w = 0; w < mask.wordsPerRow; ++w) {
+            mask.words[static_cast<std::size_t>(r) * mask.wordsPerRow + w] = mask.validBits(w);
+        }
+    }
+    return mask;
+}
+
+void TileMask::set(int row, int col, bool value) {
+    std::uint64_t& target = words[static_cast<std::size_t>(row) * wordsPerRow + (col >> 6)];
+    const std::uint64_t bit = std::uint64_t(1) << (col & 63);
+    if (value) target |= bit;
+    else target &= ~bit;
+}
+
+TileMask& TileMask::operator&=(const TileMask& other) {
+    for (std::size_t i = 0; i < words.size(); ++i) words[i] &= other.words[i];
+    return *this;
+}
+
+TileMask& TileMask::operator|=(const TileMask& other) {
+    for (std::size_t i = 0; i < words.size(); ++i) words[i] |= other.words[i];
+    return *this;
+}
+
+TileMask& TileMask::andNot(const TileMask& other) {
+    for (std::size_t i = 0; i < words.size(); ++i) words[i] &= ~other.words[i];
+    return *this;
+}
+
+TileMask& TileMask::invert() {
+    for (int r = 0; r < rows; ++r) {
+        for (int w = 0; w < wordsPerRow; ++w) {
+            std::uint64_t& target = words[static_cast<std::size_t>(r) * wordsPerRow + w];
+            target = ~target & validBits(w);
+        }
+    }
+    return *this;
+}
+
+// Bits of word `index` that are real columns
+std::uint64_t TileMask::validBits(int index) const {
+    const int remaining = cols - (index << 6);
+    return remaining >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << remaining) - 1;
+}
+
+// A word of the mask with everything off the map (rows, words and padding
+// bits) reading as `outside`
+std::uint64_t TileMask::read(int row, int index, bool outside) const {
+    const std::uint64_t fill = outside ? ~std::uint64_t(0) : 0;
+    if (row < 0 || row >= rows || index < 0 || index >= wordsPerRow) return fill;
+    return word(row, index) | (fill & ~validBits(index));
+}
+
+// Bit c of the result is the tile to the west (c - 1) / east (c + 1) of c
+static std::uint64_t westOf(std::uint64_t here, std::uint64_t before) { return (here << 1) | (before >> 63); }
+static std::uint64_t eastOf(std::uint64_t here, std::uint64_t after) { return (here >> 1) | (after << 63); }
+
+std::uint64_t TileMask::anyNeighbourWord(int row, int index, Connectivity connectivity) const {
+    auto rowWest = [&](int r) { return westOf(read(r, index, false), read(r, index - 1, false)); };
+    auto rowEast = [&](int r) { return eastOf(read(r, index, false), read(r, index + 1, false)); };
+
+    std::uint64_t result = rowWest(row) | rowEast(row) | read(row - 1, index, false) | read(row + 1, index, false);
+    if (connectivity == Connectivity::Eight) {
+        result |= rowWest(row - 1) | rowEast(row - 1) | rowWest(row + 1) | rowEast(row + 1);
+    }
+    return result & validBits(index);
+}
+
+std::uint64_t TileMask::allNeighbourWord(int row, int index, Connectivity connectivity) const {
+    auto rowWest = [&](int r) { return westOf(read(r, index, true), read(r, index - 1, true)); };
+    auto rowEast = [&](int r) { return eastOf(read(r, index, true), read(r, index + 1, true)); };
+
+    std::uint64_t result = rowWest(row) & rowEast(row) & read(row - 1, index, true) & read(row + 1, index, true);
+    if (connectivity == Connectivity::Eight) {
+        result &= rowWest(row - 1) & rowEast(row - 1) & rowWest(row + 1) & rowEast(row + 1);
+    }
+    return result & validBits(index);
+}
+
+// West and east neighbours of every tile in a row: either of them set (off the
+// map counts as clear), or both set (off the map counts as set)
+void TileMask::sideWords(int row, bool all, std::uint64_t* out) const {
+    const std::uint64_t fill = all ? ~std::uint64_t(0) : 0;
+    const std::uint64_t* line = &words[static_cast<std::size_t>(row) * wordsPerRow];
+    for (int w = 0; w < wordsPerRow; ++w) {
+        const std::uint64_t here = line[w] | (fill & ~validBits(w));
+        const std::uint64_t before = w > 0 ? line[w - 1] : fill;
+        const std::uint64_t after = w + 1 < wordsPerRow ? line[w + 1] | (fill & ~validBits(w + 1)) : fill;
+        const std::uint64_t west = westOf(here, before);
+        const std::uint64_t east = eastOf(here, after);
+        out[w] = (all ? west & east : west | east) & validBits(w);
+    }
+}
+
+// The whole-map versions work a row at a time: the sides of each row are
+// worked out once and then combined with the rows above and below
+TileMask TileMask::anyNeighbour(Connectivity connectivity) const {
+    TileMask result(rows, cols, false, getResource());
+    std::pmr::vector<std::uint64_t> sides(words.size(), getResource());
+    for (int r = 0; r < rows; ++r) sideWords(r, false, &sides[static_cast<std::size_t>(r) * wordsPerRow]);
+
+    const bool eight = connectivity == Connectivity::Eight;
+    for (int r = 0; r < rows; ++r) {
+        std::uint64_t* out = &result.words[static_cast<std::size_t>(r) * wordsPerRow];
+        for (int w = 0; w < wordsPerRow; ++w) {
+            std::uint64_t bits = sides[static_cast<std::size_t>(r) * wordsPerRow + w];
+            for (int nr : {r - 1, r + 1}) {
+                if (nr < 0 || nr >= rows) continue;
+                const std::size_t i = static_cast<std::size_t>(nr) * wordsPerRow + w;
+                bits |= words[i] | (eight ? sides[i] : 0);
+            }
+            out[w] = bits;
+        }
+    }
+    return result;
+}
+
+TileMask TileMask::allNeighbours(Connectivity connectivity) const {
+    TileMask result(rows, cols, false, getResource());
+    std::pmr::vector<std::uint64_t> sides(words.size(), getResource());
+    for (int r = 0; r < rows; ++r) sideWords(r, true, &sides[static_cast<std::size_t>(r) * wordsPerRow]);
+
+    const bool eight = connectivity == Connectivity::Eight;
+    for (int r = 0; r < rows; ++r) {
+        std::uint64_t* out = &result.words[static_cast<std::size_t>(r) * wordsPerRow];
+        for (int w = 0; w < wordsPerRow; ++w) {
+            std::uint64_t bits = sides[static_cast<std::size_t>(r) * wordsPerRow + w];
+            for (int nr : {r - 1, r + 1}) {
+                if (nr < 0 || nr >= rows) continue;
+                const std::size_t i = static_cast<std::size_t>(nr) * wordsPerRow + w;
+                bits &= words[i] & (eight ? sides[i] : ~std::uint64_t(0));
+            }
+            out[w] = bits;
+        }
+    }
+    return result;
+}
+
+long long TileMask::count() const {
+    long long total = 0;
+    for (std::uint64_t w : words) total += std::popcount(w);
+    return total;
+}
+
+bool TileMask::any() const {
+    return std::any_of(words.begin(), words.end(), [](std::uint64_t w) { return w != 0; });
+}
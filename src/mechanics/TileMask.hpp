@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Components.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// One bit per tile, 64 tiles to a word, each row padded to whole words. Set
+// algebra and neighbourhood questions ("tiles next to a river") work a word at
+// a time with shifts, so they cost about 1/64th of a per-tile scan. Padding bits
+// past the last column are always kept clear.
+//
+// The words come from a memory resource, like a std::pmr container's. Masks
+// worked out from a mask (neighbourhoods, dilate, the operators) use the same
+// resource as it (the left operand's); a plain copy uses the default one.
+class TileMask {
+public:
+    TileMask() = default;
+    TileMask(int rows, int cols, bool value = false,
+             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    TileMask(const TileMask& other, std::pmr::memory_resource* resource);
+    TileMask(const TileMask& other) = default;
+    TileMask(TileMask&& other) = default;
+    TileMask& operator=(const TileMask& other) = default;
+    TileMask& operator=(TileMask&& other) = default;
+
+    // Mask of the tiles for which matches(row, col) is true
+    template <typename Predicate>
+    static TileMask fromTiles(int rows, int cols, Predicate matches,
+                              std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        TileMask mask(rows, cols, false, resource);
+        for (int r = 0; r < rows; ++r) {
+            std::uint64_t* line = &mask.words[static_cast<std::size_t>(r) * mask.wordsPerRow];
+            for (int w = 0; w < mask.wordsPerRow; ++w) {
+                const int first = w << 6;
+                const int count = cols - first < 64 ? cols - first : 64;
+                std::uint64_t bits = 0;
+                for (int b = 0; b < count; ++b) bits |= std::uint64_t(matches(r, first + b) ? 1 : 0) << b;
+                line[w] = bits;
+            }
+        }
+        return mask;
+    }
+
+    // Mask of the map tiles whose type satisfies the predicate
+    template <typename Predicate>
+    static TileMask fromMap(const std::vector<std::vector<int>>& map, Predicate matches,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        const int rows = static_cast<int>(map.size());
+        const int cols = rows > 0 ? static_cast<int>(map[0].size()) : 0;
+        return fromTiles(rows, cols, [&](int r, int c) { return matches(map[r][c]); }, resource);
+    }
+
+    // Every tile in rows [rowBegin, rowEnd)
+    static TileMask rowBand(int rows, int cols, int rowBegin, int rowEnd,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getWordsPerRow() const { return wordsPerRow; }
+    std::pmr::memory_resource* getResource() const { return words.get_allocator().resource(); }
+
+    bool test(int row, int col) const {
+        return (words[static_cast<std::size_t>(row) * wordsPerRow + (col >> 6)] >> (col & 63)) & 1;
+    }
+    void set(int row, int col, bool value = true);
+    std::uint64_t word(int row, int index) const { return words[static_cast<std::size_t>(row) * wordsPerRow + index]; }
+
+    TileMask& operator&=(const TileMask& other);
+    TileMask& operator|=(const TileMask& other);
+    TileMask& andNot(const TileMask& other); // this & ~other
+    TileMask& invert();
+
+    friend TileMask operator&(const TileMask& a, const TileMask& b) {
+        TileMask result(a, a.getResource());
+        result &= b;
+        return result;
+    }
+    friend TileMask operator|(const TileMask& a, const TileMask& b) {
+        TileMask result(a, a.getResource());
+        result |= b;
+        return result;
+    }
+    friend TileMask operator~(const TileMask& a) {
+        TileMask result(a, a.getResource());
+        result.invert();
+        return result;
+    }
+
+    // Tiles with at least one neighbour in the mask. Tiles off the map count as clear.
+    TileMask anyNeighbour(Connectivity connectivity = Connectivity::Eight) const;
+    // Tiles whose neighbours are all in the mask. Tiles off the map count as set,
+    // so the edges are judged on the neighbours they have.
+    TileMask allNeighbours(Connectivity connectivity = Connectivity::Eight) const;
+    // The same for one word of one row, read from the mask as it is right now
+    std::uint64_t anyNeighbourWord(int row, int index, Connectivity connectivity) const;
+    std::uint64_t allNeighbourWord(int row, int index, Connectivity connectivity) const;
+
+    TileMask dilate(Connectivity connectivity = Connectivity::Eight) const {
+        TileMask result = anyNeighbour(connectivity);
+        result |= *this;
+        return result;
+    }
+    TileMask erode(Connectivity connectivity = Connectivity::Eight) const {
+        TileMask result = allNeighbours(connectivity);
+        result &= *this;
+        return result;
+    }
+
+    long long count() const;
+    bool any() const;
+
+    // Calls visit(row, col) for every set tile in row-major order
+    template <typename Visitor>
+    void forEachSet(Visitor visit) const {
+        for (int r = 0; r < rows; ++r) {
+            for (int w = 0; w < wordsPerRow; ++w) {
+                std::uint64_t bits = word(r, w);
+                while (bits) {
+                    visit(r, (w << 6) + std::countr_zero(bits));
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+
+private:
+    int rows = 0, cols = 0, wordsPerRow = 0;
+    std::pmr::vector<std::uint64_t> words; // row-major, wordsPerRow per row
+
+    std::uint64_t validBits(int index) const;
+    std::uint64_t read(int row, int index, bool outside) const;
+    void sideWords(int row, bool all, std::uint64_t* out) const;
+};
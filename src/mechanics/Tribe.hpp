@@ -4,19 +4,24 @@
 #include <string>
 #include <functional>
 
-class UITools;
+class UILayer;
 
 class Tribe {
 public:
     Tribe(int rows, int cols);
-    void spawn(const std::vector<std::vector<int>>& terrainMap);
-    void revealFoW(std::vector<std::vector<int>>& fogGrid) const;
-    sf::RectangleShape getPlayerMarker(float cellSize) const;
+    // Position comes from the simulation, which spawns and moves tribes
+    void setPosition(int row, int col);
     int getRow() const;
     int getCol() const;
 
-    bool drawTribeMenu(UITools& UITools, sf::RenderWindow& window, const sf::View& view, sf::Vector2f position, sf::Font& font, float cellSize, std::pair<int, int> playerPos);
-    void moveToTile(int newRow, int newCol);
+    // Builds the (hidden) tribe menu once; returns its panel so the caller can place and show it
+    int createTribeMenu(UILayer& ui, float cellSize);
+    // Called by the Settle button; the owner decides how a village gets founded
+    void setSettleHandler(std::function<void()> handler);
+    bool isMoveModeActive() const;
+    void endMoveMode();
+    // In bounds and inside the move radius shown by the highlights
+    bool canMoveTo(int row, int col) const;
 
     void drawMoveHighlights(sf::RenderWindow& window) const;
     // std::vector<HighlightTile> moveHighlights;
@@ -28,19 +33,14 @@ private:
     int rows, cols;
 
     // Dummy button handlers
-    void onMoveClicked(float cellSize, std::pair<int, int> playerPos);
+    void onMoveClicked(float cellSize);
     void onSettleClicked();
     void onTest1Clicked();
     void onTest2Clicked();
     void onTest3Clicked();
 
-    sf::Clock moveCooldown;
-    sf::Clock settleCooldown;
-    sf::Clock test1Cooldown;
-    sf::Clock test2Cooldown;
-    sf::Clock test3Cooldown;
-    const float cooldownDuration = 0.3f; // seconds
-
+    static const int MoveRadius = 5;
     bool moveModeActive = false;
+    std::function<void()> settleHandler;
     std::vector<sf::RectangleShape> moveHighlights; // Highlight overlay
 };
@@ -0,0 +1,214 @@
+#include "Village.hpp"
+#include "../Tools/ParallelFor.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Food and growth tuning. A person works about one fertility point of land and
+// eats a fifth of it, so well-fed villages grow until they run out of land.
+static const float WorkPerPerson = 1.0f;
+static const float FoodPerPerson = 0.2f;
+static const float PeoplePerFertility = 2.0f;
+static const float GrowthRate = 0.05f;
+static const float StarvationRate = 0.5f;
+static const float StorageTurns = 10.0f;   // food kept is capped at this many turns of eating
+static const int ChunkSize = 1024;
+
+VillageSystem::VillageSystem(int rows, int cols, const std::vector<std::vector<float>>& fertilityGrid)
+    : rows(rows), cols(cols), fertility(rows * cols, 0.0f), owner(rows * cols, -1) {
+    for (int r = 0; r < rows && r < static_cast<int>(fertilityGrid.size()); ++r) {
+        std::copy(fertilityGrid[r].begin(), fertilityGrid[r].begin() + std::min<int>(cols, fertilityGrid[r].size()),
+                  fertility.begin() + r * cols);
+    }
+}
+
+// Claim radius a village of this size works towards
+static int radiusForPopulation(float population) {
+    return std::min(VillageSystem::MaxRadius, 1 + static_cast<int>(std::sqrt(population / 25.0f)));
+}
+
+int VillageSystem::found(int r, int c, int founder) {
+    if (r < 0 || r >= rows || c < 0 || c >= cols) return -1;
+    if (owner[r * cols + c] != -1 || fertility[r * cols + c] < MinFoundingFertility) return -1;
+
+    int id = static_cast<int>(row.size());
+    row.push_back(r);
+    col.push_back(c);
+    tribe.push_back(founder);
+    name.push_back(NameService::InvalidName);
+    radius.push_back(0);
+    tileCount.push_back(0);
+    population.push_back(FoundingPopulation);
+    food.push_back(0.0f);
+    yield.push_back(0.0f);
+    alive.push_back(1);
+    wantsRadius.push_back(0);
+    ++living;
+
+    claim(id, r, c);
+    growTerritory(id, radiusForPopulation(FoundingPopulation));
+    return id;
+}
+
+void VillageSystem::claim(int id, int r, int c) {
+    owner[r * cols + c] = id;
+    changedTiles.push_back(r * cols + c);
+    tileCount[id] += 1;
+    yield[id] += fertility[r * cols + c];
+}
+
+// Claims the free tiles between the current radius and newRadius; tiles closer
+// in were already offered when the village reached their ring
+void VillageSystem::growTerritory(int id, int newRadius) {
+    const int oldRadius = radius[id];
+    if (newRadius <= oldRadius) return;
+
+    const int centerRow = row[id];
+    const int centerCol = col[id];
+    const int rowBegin = std::max(0, centerRow - newRadius);
+    const int rowEnd = std::min(rows - 1, centerRow + newRadius);
+    const int colBegin = std::max(0, centerCol - newRadius);
+    const int colEnd = std::min(cols - 1, centerCol + newRadius);
+
+    for (int r = rowBegin; r <= rowEnd; ++r) {
+        for (int c = colBegin; c <= colEnd; ++c) {
+            int distanceSquared = (r - centerRow) * (r - centerRow) + (c - centerCol) * (c - centerCol);
+            if (distanceSquared <= oldRadius * oldRadius || distanceSquared > newRadius * newRadius) continue;
+            if (owner[r * cols + c] == -1 && fertility[r * cols + c] > 0.0f) claim(id, r, c);
+        }
+    }
+    radius[id] = newRadius;
+}
+
+// Hands the village's tiles back; they can only be inside its radius
+void VillageSystem::abandon(int id) {
+    const int reach = radius[id];
+    releasedTiles.clear();
+    for (int r = std::max(0, row[id] - reach); r <= std::min(rows - 1, row[id] + reach); ++r) {
+        for (int c = std::max(0, col[id] - reach); c <= std::min(cols - 1, col[id] + reach); ++c) {
+            if (owner[r * cols + c] == id) {
+                owner[r * cols + c] = -1;
+                changedTiles.push_back(r * cols + c);
+                releasedTiles.push_back(r * cols + c);
+            }
+        }
+    }
+    reofferReleased(row[id], col[id], reach);
+    alive[id] = 0;
+    population[id] = 0.0f;
+    food[id] = 0.0f;
+    yield[id] = 0.0f;
+    tileCount[id] = 0;
+    --living;
+}
+
+// growTerritory only offers a ring once, when a village reaches it, so tiles
+// freed inside a neighbour's radius go to that neighbour now. Those neighbours
+// have their centres within reach + MaxRadius, and a living village always owns
+// its centre, so the owner grid finds them. Lowest id first, as in updateTurn.
+void VillageSystem::reofferReleased(int centerRow, int centerCol, int reach) {
+    const int search = reach + MaxRadius;
+    nearbyVillages.clear();
+    for (int r = std::max(0, centerRow - search); r <= std::min(rows - 1, centerRow + search); ++r) {
+        for (int c = std::max(0, centerCol - search); c <= std::min(cols - 1, centerCol + search); ++c) {
+            const int other = owner[r * cols + c];
+            if (other != -1 && row[other] == r && col[other] == c) nearbyVillages.push_back(other);
+        }
+    }
+    std::sort(nearbyVillages.begin(), nearbyVillages.end());
+
+    for (int other : nearbyVillages) {
+        const int radiusSquared = radius[other] * radius[other];
+        for (int index : releasedTiles) {
+            if (owner[index] != -1 || fertility[index] <= 0.0f) continue;
+            const int r = index / cols, c = index % cols;
+            const int distanceSquared = (r - row[other]) * (r - row[other]) + (c - col[other]) * (c - col[other]);
+            if (distanceSquared <= radiusSquared) claim(other, r, c);
+        }
+    }
+}
+
+void VillageSystem::updateTurn(int threads) {
+    PROFILE_SCOPE("VillageSystem::updateTurn");
+    const int count = getCount();
+    const int chunks = (count + ChunkSize - 1) / ChunkSize;
+
+    // Each village only reads and writes its own entries, so chunks run in any order
+    parallelFor(chunks, threads, [&](int chunk) {
+        const int end = std::min(count, (chunk + 1) * ChunkSize);
+        for (int i = chunk * ChunkSize; i < end; ++i) {
+            if (!alive[i]) continue;
+
+            float people = population[i];
+            float produced = std::min(yield[i], people * WorkPerPerson);
+            float stored = food[i] + produced - people * FoodPerPerson;
+
+            if (stored >= 0.0f) {
+                float capacity = std::max(1.0f, yield[i] * PeoplePerFertility);
+                people += GrowthRate * people * (1.0f - people / capacity);
+            } else {
+                people += stored / FoodPerPerson * StarvationRate;
+                stored = 0.0f;
+            }
+
+            population[i] = std::max(0.0f, people);
+            food[i] = std::min(stored, population[i] * FoodPerPerson * StorageTurns);
+
+            int target = radiusForPopulation(population[i]);
+            wantsRadius[i] = population[i] < 1.0f ? -1 : (target > radius[i] ? static_cast<signed char>(target) : 0);
+        }
+    });
+
+    // Claims touch the shared owner grid, so they are applied in id order: older
+    // villages win contested tiles and the result is the same on any thread count
+    for (int i = 0; i < count; ++i) {
+        if (wantsRadius[i] == 0) continue;
+        if (wantsRadius[i] < 0) {
+            abandon(i);
+        } else {
+            growTerritory(i, wantsRadius[i]);
+        }
+        wantsRadius[i] = 0;
+    }
+}
+
+void VillageSystem::setName(int id, NameId newName) {
+    name[id] = newName;
+}
+
+int VillageSystem::getCount() const {
+    return static_cast<int>(row.size());
+}
+
+int VillageSystem::getLiving() const {
+    return living;
+}
+
+bool VillageSystem::isAlive(int id) const {
+    return id >= 0 && id < getCount() && alive[id];
+}
+
+double VillageSystem::getTotalPopulation() const {
+    double total = 0.0;
+    for (float people : population) total += people;
+    return total;
+}
+
+int VillageSystem::getOwner(int r, int c) const {
+    if (r < 0 || r >= rows || c < 0 || c >= cols) return -1;
+    return owner[r * cols + c];
+}
+
+const std::vector<int>& VillageSystem::getOwnerGrid() const { return owner; }
+const std::vector<int>& VillageSystem::getChangedTiles() const { return changedTiles; }
+void VillageSystem::clearChangedTiles() { changedTiles.clear(); }
+const std::vector<int>& VillageSystem::getRows() const { return row; }
+const std::vector<int>& VillageSystem::getCols() const { return col; }
+const std::vector<int>& VillageSystem::getTribes() const { return tribe; }
+const std::vector<NameId>& VillageSystem::getNames() const { return name; }
+const std::vector<int>& VillageSystem::getRadii() const { return radius; }
+const std::vector<int>& VillageSystem::getTileCounts() const { return tileCount; }
+const std::vector<float>& VillageSystem::getPopulations() const { return population; }
+const std::vector<float>& VillageSystem::getFood() const { return food; }
+const std::vector<float>& VillageSystem::getYields() const { return yield; }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Names.hpp"
+
+#include <vector>
+
+// Settlements, stored as one array per field indexed by village id so the
+// per-turn update streams through memory and splits into independent chunks.
+//
+// Each village claims the tiles around it in a per-tile owner grid. Claims are
+// only touched where they change: a growing village claims the next ring of free
+// tiles, an abandoned one releases its own to whichever neighbours already reach
+// them. Its food yield is the sum of the fertility it owns, kept up to date as
+// tiles come and go.
+class VillageSystem {
+public:
+    VillageSystem(int rows, int cols, const std::vector<std::vector<float>>& fertility);
+
+    // Founds a village for `tribe` at (row, col). Returns its id, or -1 if the tile
+    // is off the map, already claimed, or too barren to live on.
+    int found(int row, int col, int tribe);
+    // One turn of food and population for every village, with chunks spread over
+    // `threads` threads (0 = one per core). Results don't depend on the thread count.
+    void updateTurn(int threads = 1);
+    void setName(int id, NameId name);
+
+    int getCount() const;   // ids handed out, abandoned villages included
+    int getLiving() const;
+    bool isAlive(int id) const;
+    double getTotalPopulation() const;
+
+    int getOwner(int row, int col) const; // village id, or -1 if unclaimed
+    const std::vector<int>& getOwnerGrid() const; // row-major
+    // Row-major indices of tiles claimed or released since the last clear, for
+    // layers that follow ownership incrementally (may repeat a tile)
+    const std::vector<int>& getChangedTiles() const;
+    void clearChangedTiles();
+
+    const std::vector<int>& getRows() const;
+    const std::vector<int>& getCols() const;
+    const std::vector<int>& getTribes() const;
+    const std::vector<NameId>& getNames() const;
+    const std::vector<int>& getRadii() const;
+    const std::vector<int>& getTileCounts() const;
+    const std::vector<float>& getPopulations() const;
+    const std::vector<float>& getFood() const;
+    const std::vector<float>& getYields() const;
+
+    static constexpr float FoundingPopulation = 10.0f;
+    static constexpr float MinFoundingFertility = 1.0f;
+    static constexpr int MaxRadius = 4;
+
+private:
+    void growTerritory(int id, int newRadius);
+    void abandon(int id);
+    void reofferReleased(int centerRow, int centerCol, int reach);
+    void claim(int id, int row, int col);
+
+    int rows, cols;
+    std::vector<float> fertility; // row-major copy of the fertility grid
+    std::vector<int> owner;       // row-major, -1 = unclaimed
+    std::vector<int> changedTiles;
+    std::vector<int> releasedTiles;  // abandon's working lists, kept for their storage
+    std::vector<int> nearbyVillages;
+    int living = 0;
+
+    // One entry per village
+    std::vector<int> row;
+    std::vector<int> col;
+    std::vector<int> tribe;
+    std::vector<NameId> name;
+    std::vector<int> radius;      // claim radius reached so far
+    std::vector<int> tileCount;   // tiles currently owned
+    std::vector<float> population;
+    std::vector<float> food;
+    std::vector<float> yield;     // fertility summed over owned tiles
+    std::vector<char> alive;
+    std::vector<signed char> wantsRadius; // set by the parallel pass (-1 = abandon), applied serially after it
+};
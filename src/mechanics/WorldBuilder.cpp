@@ -0,0 +1,161 @@
+#include "WorldBuilder.hpp"
+#include "../Tools/OverlayTools.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+WorldBuilder::WorldBuilder(int rows, int cols, float cellSize)
+    : rows(rows), cols(cols), cellSize(cellSize) {}
+
+WorldBuilder::~WorldBuilder() {
+    // Shutting down is the one place a wait is fine: the long stages poll the flag
+    retireCurrent();
+    for (Worker& worker : retired) worker.thread.join();
+}
+
+void WorldBuilder::start(unsigned int seed) {
+    retireCurrent();
+    joinFinished();
+
+    current.job = std::make_shared<Job>();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        status = "Starting";
+        result.reset();
+        progress = 0.0f;
+        running = true;
+    }
+    current.thread = std::thread(&WorldBuilder::run, this, seed, current.job);
+}
+
+void WorldBuilder::setStageConfig(const std::string& path) {
+    stageConfigPath = path;
+}
+
+void WorldBuilder::cancel() {
+    retireCurrent();
+    joinFinished();
+}
+
+// The flag is set under the lock, so once this returns the job can't publish
+void WorldBuilder::retireCurrent() {
+    if (!current.job) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current.job->cancelRequested = true;
+        running = false;
+        result.reset();
+    }
+    retired.push_back(std::move(current));
+    current = {};
+}
+
+void WorldBuilder::joinFinished() {
+    std::erase_if(retired, [](Worker& worker) {
+        if (!worker.job->finished) return false;
+        worker.thread.join(); // returns at once: run() has nothing left to do
+        return true;
+    });
+}
+
+bool WorldBuilder::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+float WorldBuilder::getProgress() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return progress;
+}
+
+std::string WorldBuilder::getStatus() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return status;
+}
+
+bool WorldBuilder::pollPreview(int& version, sf::VertexArray& grid) {
+    joinFinished();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (version == previewVersion) return false;
+    grid = std::move(previewGrid);
+    version = previewVersion;
+    return true;
+}
+
+std::unique_ptr<WorldData> WorldBuilder::takeResult() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::move(result);
+}
+
+void WorldBuilder::run(unsigned int seed, std::shared_ptr<Job> job) {
+    Profiler::setThreadName("worldgen");
+    build(seed, *job);
+    job->finished = true;
+}
+
+void WorldBuilder::build(unsigned int seed, Job& job) {
+    MapGenerator mapGenerator(rows, cols, seed);
+    mapGenerator.setCancelFlag(&job.cancelRequested);
+    if (!stageConfigPath.empty() && !mapGenerator.loadStageConfig(stageConfigPath)) {
+        std::cerr << "Using the default generation stages\n";
+    }
+
+    // Two extra steps after the map itself: fertility and overlays
+    const int totalSteps = mapGenerator.getStageCount() + 2;
+
+    auto publish = [&](int step, const char* name, double millis, bool withPreview) {
+        std::ostringstream text;
+        text << name << " (" << std::fixed << std::setprecision(1) << millis << " ms)";
+
+        // Build the preview outside the lock, then publish it
+        PROFILE_SCOPE("worldgen preview");
+        sf::VertexArray grid;
+        if (withPreview) grid = createTerrainGrid(mapGenerator.getMap(), cellSize, seed);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (job.cancelRequested) return;
+        progress = static_cast<float>(step + 1) / totalSteps;
+        status = text.str();
+        if (withPreview) {
+            previewGrid = std::move(grid);
+            ++previewVersion;
+        }
+    };
+
+    bool completed = mapGenerator.generateMap([&](const GenerationProgress& p) {
+        publish(p.stageIndex, p.stageName, p.stageMillis, true);
+        return true; // the cancel flag is checked by the generator
+    });
+    if (!completed) return;
+    // Stage timings only while the profiler overlay is up, which is when someone is looking for them
+    if (Profiler::isEnabled()) {
+        std::cout << "[worldgen] seed " << seed << "\n";
+        mapGenerator.getPipeline().printTimings(std::cout);
+    }
+
+    auto world = std::make_unique<WorldData>(rows, cols);
+    world->seed = seed;
+    world->map = mapGenerator.getMap();
+    world->terrain.build(world->map, cellSize, seed);
+
+    auto start = std::chrono::steady_clock::now();
+    world->fertility.generateFromTerrain(world->map, seed);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    publish(totalSteps - 2, "fertility", elapsed.count(), false);
+    if (job.cancelRequested) return;
+
+    start = std::chrono::steady_clock::now();
+    world->fertilityOverlay = createFertilityOverlay(world->fertility, cellSize);
+    elapsed = std::chrono::steady_clock::now() - start;
+    publish(totalSteps - 1, "overlays", elapsed.count(), false);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!job.cancelRequested) {
+        status = "Done";
+        result = std::move(world);
+        running = false;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MapGenerator.hpp"
+#include "Fertility.hpp"
+#include "../Tools/TerrainLod.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Everything the game needs once generation has finished
+struct WorldData {
+    unsigned int seed;
+    std::vector<std::vector<int>> map;
+    FertilityMap fertility;
+    TerrainLod terrain;
+    sf::VertexArray fertilityOverlay;
+
+    WorldData(int rows, int cols) : seed(0), fertility(rows, cols) {}
+};
+
+// Runs map generation on a background thread so the window keeps drawing.
+// After every stage the partially generated terrain is published as a preview.
+// Nothing here waits for a worker except the destructor: a cancelled build is
+// told to stop and its thread is joined once it has, from a later call.
+class WorldBuilder {
+public:
+    WorldBuilder(int rows, int cols, float cellSize);
+    ~WorldBuilder();
+
+    // Cancels any build in progress and starts a new one with this seed
+    void start(unsigned int seed);
+    // Generation stage order file applied to every build (see GenerationPipeline)
+    void setStageConfig(const std::string& path);
+    // Tells the current build to stop and discards its result, without waiting for it
+    void cancel();
+
+    bool isRunning() const;
+    float getProgress() const;      // 0..1
+    std::string getStatus() const;  // e.g. "smoothMap (12.3 ms)"
+
+    // Moves the newest preview grid into `grid` if one is newer than previewVersion
+    bool pollPreview(int& previewVersion, sf::VertexArray& grid);
+
+    // Non-null exactly once per finished build
+    std::unique_ptr<WorldData> takeResult();
+
+private:
+    // Shared by a build's thread and the builder; outlives whichever lets go last
+    struct Job {
+        std::atomic<bool> cancelRequested{false};
+        std::atomic<bool> finished{false}; // the thread is about to return
+    };
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<Job> job;
+    };
+
+    void run(unsigned int seed, std::shared_ptr<Job> job);
+    void build(unsigned int seed, Job& job);
+    void retireCurrent();
+    void joinFinished(); // joins retired workers that are done; never blocks
+
+    int rows, cols;
+    float cellSize;
+    std::string stageConfigPath;
+
+    Worker current;
+    std::vector<Worker> retired; // cancelled, maybe still finishing their stage
+
+    mutable std::mutex mutex;       // guards everything below
+    // A cancelled job publishes nothing, so these only ever describe the current one
+    bool running = false;
+    float progress = 0.0f;
+    std::string status;
+    int previewVersion = 0;
+    sf::VertexArray previewGrid;
+    std::unique_ptr<WorldData> result;
+};
@@ -0,0 +1,82 @@
+#include "Zoom.hpp"
+#include "../Tools/Profiler.hpp"
+
+#include <algorithm>
+
+// Majority of the four corners of a block, or one of them picked by `bits`
+static int modeOrRandom(int a, int b, int c, int d, unsigned int bits) {
+    if (b == c && c == d) return b;
+    if (a == b && (a == c || a == d || c != d)) return a;
+    if (a == c && (a == d || b != d)) return a;
+    if (a == d && b != c) return a;
+    if (b == c && a != d) return b;
+    if (b == d && a != c) return b;
+    if (c == d && a != b) return c;
+    const int corners[4] = {a, b, c, d};
+    return corners[bits & 3u];
+}
+
+ZoomGrid zoomTiles(const ZoomGrid& grid, std::mt19937& rng) {
+    const int rows = static_cast<int>(grid.size());
+    const int cols = rows > 0 ? static_cast<int>(grid[0].size()) : 0;
+    ZoomGrid zoomed(grid.get_allocator());
+    zoomed.reserve(rows * 2);
+    for (int row = 0; row < rows * 2; ++row) zoomed.emplace_back(cols * 2);
+
+    for (int row = 0; row < rows; ++row) {
+        const std::pmr::vector<int>& line = grid[row];
+        const std::pmr::vector<int>& below = grid[row + 1 < rows ? row + 1 : row];
+        std::pmr::vector<int>& top = zoomed[row * 2];
+        std::pmr::vector<int>& bottom = zoomed[row * 2 + 1];
+        for (int col = 0; col < cols; ++col) {
+            const int right = col + 1 < cols ? col + 1 : col;
+            const int a = line[col], b = line[right], c = below[col], d = below[right];
+            const unsigned int bits = rng(); // one draw covers the three choices
+            top[col * 2] = a;
+            top[col * 2 + 1] = bits & 1u ? b : a;
+            bottom[col * 2] = bits & 2u ? c : a;
+            bottom[col * 2 + 1] = modeOrRandom(a, b, c, d, bits >> 2);
+        }
+    }
+    return zoomed;
+}
+
+void smoothZoomedTiles(ZoomGrid& grid, std::mt19937& rng) {
+    const int rows = static_cast<int>(grid.size());
+    const int cols = rows > 0 ? static_cast<int>(grid[0].size()) : 0;
+    const ZoomGrid source(grid, grid.get_allocator());
+
+    // Off-map neighbours count as the tile itself
+    for (int row = 0; row < rows; ++row) {
+        const std::pmr::vector<int>& line = source[row];
+        const std::pmr::vector<int>& above = source[row > 0 ? row - 1 : row];
+        const std::pmr::vector<int>& below = source[row + 1 < rows ? row + 1 : row];
+        for (int col = 0; col < cols; ++col) {
+            const int left = line[col > 0 ? col - 1 : col], right = line[col + 1 < cols ? col + 1 : col];
+            const int up = above[col], down = below[col];
+            if (left == right && up == down) {
+                grid[row][col] = left == up || (rng() & 1u) ? left : up;
+            } else if (left == right) {
+                grid[row][col] = left;
+            } else if (up == down) {
+                grid[row][col] = up;
+            }
+        }
+    }
+}
+
+void upsampleTiles(const std::vector<std::vector<int>>& coarse, int levels, std::vector<std::vector<int>>& out,
+                   std::mt19937& rng, std::pmr::memory_resource* resource) {
+    PROFILE_SCOPE("upsampleTiles");
+    ZoomGrid grid(resource);
+    grid.reserve(coarse.size());
+    for (const std::vector<int>& line : coarse) grid.emplace_back(line.begin(), line.end());
+    for (int level = 0; level < levels; ++level) {
+        grid = zoomTiles(grid, rng);
+        smoothZoomedTiles(grid, rng);
+    }
+
+    for (std::size_t row = 0; row < out.size(); ++row) {
+        std::copy_n(grid[row].begin(), out[row].size(), out[row].begin());
+    }
+}
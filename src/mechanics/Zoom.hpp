@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+// Intermediate grids of the zoom, kept in a caller-supplied memory resource
+using ZoomGrid = std::pmr::vector<std::pmr::vector<int>>;
+
+// Doubles a tile grid in both directions, layered-generator style: each tile
+// becomes a 2x2 block whose top-left corner keeps it, whose right and bottom
+// corners take it or the neighbour on that side at random, and whose
+// bottom-right corner takes the majority of the four (or one at random), so
+// boundaries come out ragged rather than blocky. The result uses the grid's
+// memory resource.
+ZoomGrid zoomTiles(const ZoomGrid& grid, std::mt19937& rng);
+
+// Irons out the one-tile specks and steps a zoom leaves: a tile whose left and
+// right neighbours agree takes their type, likewise up and down (a coin toss
+// if both pairs agree on different types).
+void smoothZoomedTiles(ZoomGrid& grid, std::mt19937& rng);
+
+// `levels` rounds of zoom and smooth, cropped into `out`, which must already
+// have its final size. The coarse grid must be at least out's size / 2^levels,
+// rounded up. The intermediate grids come from `resource`.
+void upsampleTiles(const std::vector<std::vector<int>>& coarse, int levels, std::vector<std::vector<int>>& out,
+                   std::mt19937& rng, std::pmr::memory_resource* resource = std::pmr::get_default_resource());